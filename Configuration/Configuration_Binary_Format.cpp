@@ -0,0 +1,54 @@
+#include "Configuration_Binary_Format.hpp"
+#include <bit>
+
+static_assert(std::endian::native == std::endian::little, "binary configs are written in host byte order");
+
+namespace {
+
+template<typename T>
+void Append(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+} // namespace
+
+bool ConfigBinaryFormat::IsBinary(std::string_view data) {
+    return data.size() >= kHeaderSize && std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+bool ConfigBinaryFormat::Encode(const std::vector<ConfigSystem::ComponentState>& components, std::string& out, std::string* error) {
+    size_t total = kHeaderSize;
+    for (const auto& s : components) {
+        if (s.id.size() > kMaxIdLength) {
+            if (error) *error = "component id longer than 65535 bytes: " + s.id.substr(0, 64) + "...";
+            return false;
+        }
+        total += 2 + s.id.size() + kRecordSize;
+    }
+
+    out.clear();
+    out.reserve(total);
+    out.append(kMagic, sizeof(kMagic));
+    Append<std::uint16_t>(out, kVersion);
+    Append<std::uint16_t>(out, 0);
+    Append<std::uint32_t>(out, static_cast<std::uint32_t>(components.size()));
+
+    for (const auto& s : components) {
+        Append<std::uint16_t>(out, static_cast<std::uint16_t>(s.id.size()));
+        out.append(s.id.data(), s.id.size());
+        Append<std::uint8_t>(out, static_cast<std::uint8_t>((s.is_open ? 1 : 0) | (s.checkbox ? 2 : 0)));
+        Append(out, s.position.x);
+        Append(out, s.position.y);
+        Append(out, s.size.x);
+        Append(out, s.size.y);
+        Append(out, s.slider_float);
+        Append<std::int32_t>(out, s.slider_int);
+        Append(out, s.color.x);
+        Append(out, s.color.y);
+        Append(out, s.color.z);
+        Append(out, s.color.w);
+    }
+    return true;
+}
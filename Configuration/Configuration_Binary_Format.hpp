@@ -0,0 +1,86 @@
+#pragma once
+#include "Configuration_System.hpp"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Fixed layout binary encoding of config components.
+//
+//   header:    "RCFG" | u16 version | u16 reserved | u32 component count
+//   component: u16 id length | id bytes | u8 flags (1 = is_open, 2 = checkbox)
+//              | f32 position[2] | f32 size[2] | f32 slider_float | i32 slider_int | f32 color[4]
+//
+// All values are little endian.
+class ConfigBinaryFormat {
+public:
+    static constexpr char kMagic[4] = {'R', 'C', 'F', 'G'};
+    static constexpr std::uint16_t kVersion = 1;
+    static constexpr const char* kExtension = ".rcfg";
+
+    static bool IsBinary(std::string_view data);
+
+    // Fails on an id too long for its u16 length rather than truncating it.
+    static bool Encode(const std::vector<ConfigSystem::ComponentState>& components, std::string& out, std::string* error = nullptr);
+
+    template<typename Sink>
+    static bool Decode(std::string_view data, Sink&& sink, std::string* error = nullptr);
+
+private:
+    static constexpr size_t kHeaderSize = 12;
+    static constexpr size_t kMaxIdLength = 0xFFFF;
+    static constexpr size_t kRecordSize = 1 + 4 * 2 + 4 * 2 + 4 + 4 + 4 * 4;
+};
+
+namespace config_binary_detail {
+
+template<typename T>
+inline T Read(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace config_binary_detail
+
+template<typename Sink>
+bool ConfigBinaryFormat::Decode(std::string_view data, Sink&& sink, std::string* error) {
+    using config_binary_detail::Read;
+
+    auto fail = [error](const char* why) {
+        if (error) *error = why;
+        return false;
+    };
+
+    if (!IsBinary(data)) return fail("missing binary config header");
+    if (Read<std::uint16_t>(data.data() + 4) != kVersion) return fail("unsupported binary config version");
+
+    std::uint32_t count = Read<std::uint32_t>(data.data() + 8);
+    const char* p = data.data() + kHeaderSize;
+    const char* end = data.data() + data.size();
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (end - p < 2) return fail("truncated binary config");
+        std::uint16_t idLength = Read<std::uint16_t>(p);
+        p += 2;
+        if (static_cast<size_t>(end - p) < idLength + kRecordSize) return fail("truncated binary config");
+
+        ConfigSystem::ComponentState s;
+        s.id.assign(p, idLength);
+        p += idLength;
+
+        std::uint8_t flags = static_cast<std::uint8_t>(*p++);
+        s.is_open = (flags & 1) != 0;
+        s.checkbox = (flags & 2) != 0;
+        s.position = ImVec2(Read<float>(p), Read<float>(p + 4));
+        s.size = ImVec2(Read<float>(p + 8), Read<float>(p + 12));
+        s.slider_float = Read<float>(p + 16);
+        s.slider_int = Read<std::int32_t>(p + 20);
+        s.color = ImVec4(Read<float>(p + 24), Read<float>(p + 28), Read<float>(p + 32), Read<float>(p + 36));
+        p += kRecordSize - 1;
+
+        sink(std::move(s));
+    }
+    return true;
+}
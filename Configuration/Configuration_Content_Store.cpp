@@ -0,0 +1,196 @@
+#include "Configuration_Content_Store.hpp"
+#include "Configuration_Binary_Format.hpp"
+#include "../File/Log_Modules.hpp"
+#include "../File/Mapped_File.hpp"
+#include <cstdint>
+#include <fstream>
+
+namespace {
+
+const char* kManifestExtension = ".manifest";
+
+} // namespace
+
+ConfigContentStore::ConfigContentStore(fs::path root)
+    : root_(std::move(root)), objects_dir_(root_ / "objects"), manifests_dir_(root_ / "manifests") {}
+
+bool ConfigContentStore::Initialize() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        fs::create_directories(objects_dir_);
+        fs::create_directories(manifests_dir_);
+
+        known_blobs_.clear();
+        for (const auto& entry : fs::recursive_directory_iterator(objects_dir_)) {
+            if (entry.is_regular_file() && entry.path().extension().empty())
+                known_blobs_.emplace(entry.path().filename().string(), std::string());
+        }
+        return true;
+    } catch (const std::exception& e) {
+        RLOG_ERROR(ConfigSystem, "Config store failed to initialize: {}", e.what());
+        return false;
+    }
+}
+
+bool ConfigContentStore::Save(const std::string& name, const std::vector<ComponentState>& components, size_t* blobs_written) {
+    if (!IsManifestName(name)) {
+        RLOG_ERROR(ConfigSystem, "Config store failed to save {}: not a manifest name", name);
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t written = 0;
+    json manifest;
+    manifest["blobs"] = json::object();
+
+    std::string blob, error;
+    for (const auto& state : components) {
+        if (!ConfigBinaryFormat::Encode({state}, blob, &error)) {
+            RLOG_ERROR(ConfigSystem, "Config store failed to save {}: {}", name, error);
+            return false;
+        }
+        std::string key = StoreBlob(blob, written);
+        if (key.empty()) return false;
+        manifest["blobs"][state.id] = key;
+    }
+
+    if (blobs_written) *blobs_written = written;
+    return ConfigSystem::WriteConfigFile(ManifestPath(name).string(), manifest.dump(1));
+}
+
+std::string ConfigContentStore::StoreBlob(const std::string& blob, size_t& written) {
+    const std::string hash = HashBlob(blob);
+    std::string key = hash;
+    for (int n = 1;; key = hash + "-" + std::to_string(n++)) {
+        auto it = known_blobs_.find(key);
+        if (it != known_blobs_.end()) {
+            // Read once per run, later saves compare in memory.
+            if (it->second.empty()) {
+                MappedFile stored(BlobPath(key));
+                if (stored.isOpen()) it->second.assign(stored.view());
+            }
+            if (it->second == blob) return key;
+            if (!it->second.empty()) continue; // a different blob with the same hash
+        }
+
+        // New, or known but gone from disk: (re)write it under this key.
+        fs::path path = BlobPath(key);
+        std::error_code ec;
+        fs::create_directories(path.parent_path(), ec);
+        if (!ConfigSystem::WriteConfigFile(path.string(), blob)) return std::string();
+        known_blobs_[key] = blob;
+        ++written;
+        return key;
+    }
+}
+
+bool ConfigContentStore::Load(const std::string& name, std::vector<ComponentState>& components) {
+    // CollectGarbage may otherwise sweep a blob between reading the manifest and the blob.
+    std::lock_guard<std::mutex> lock(mutex_);
+    try {
+        if (!IsManifestName(name)) throw std::runtime_error("not a manifest name");
+        std::ifstream file(ManifestPath(name));
+        if (!file) throw std::runtime_error("no manifest named " + name);
+        json manifest;
+        file >> manifest;
+
+        // Blobs are written once and only ever replaced by rename, so mapping them is safe.
+        for (auto& [id, hash] : manifest.at("blobs").items()) {
+            if (!IsBlobKey(hash.get<std::string>())) throw std::runtime_error("bad blob key " + hash.get<std::string>());
+            MappedFile blob(BlobPath(hash.get<std::string>()));
+            std::string error;
+            bool ok = blob.isOpen() && ConfigBinaryFormat::Decode(blob.view(), [&](ComponentState&& state) {
+                state.id = id;
+                components.push_back(std::move(state));
+            }, &error);
+            if (!ok) throw std::runtime_error("missing or corrupt blob " + hash.get<std::string>() + " " + error);
+        }
+        return true;
+    } catch (const std::exception& e) {
+        RLOG_ERROR(ConfigSystem, "Config store failed to load {}: {}", name, e.what());
+        return false;
+    }
+}
+
+std::vector<std::string> ConfigContentStore::ListManifests() const {
+    std::vector<std::string> names;
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(manifests_dir_, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        if (it->path().extension() == kManifestExtension)
+            names.push_back(it->path().stem().string());
+    }
+    return names;
+}
+
+size_t ConfigContentStore::CollectGarbage() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_set<std::string> referenced;
+
+    try {
+        // mark
+        for (const auto& entry : fs::directory_iterator(manifests_dir_)) {
+            if (entry.path().extension() != kManifestExtension) continue;
+            std::ifstream file(entry.path());
+            json manifest;
+            file >> manifest;
+            for (auto& [id, hash] : manifest.at("blobs").items())
+                referenced.insert(hash.get<std::string>());
+        }
+    } catch (const std::exception& e) {
+        // never sweep on a partial mark, that could delete live blobs
+        RLOG_ERROR(ConfigSystem, "Config store garbage collection aborted: {}", e.what());
+        return 0;
+    }
+
+    // sweep
+    size_t removed = 0;
+    for (auto it = known_blobs_.begin(); it != known_blobs_.end();) {
+        if (referenced.count(it->first)) {
+            ++it;
+            continue;
+        }
+        std::error_code ec;
+        fs::remove(BlobPath(it->first), ec);
+        if (ec) {
+            ++it;
+            continue;
+        }
+        ++removed;
+        it = known_blobs_.erase(it);
+    }
+    return removed;
+}
+
+std::string ConfigContentStore::HashBlob(std::string_view data) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    static const char* digits = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, hash >>= 4) hex[i] = digits[hash & 0xF];
+    return hex;
+}
+
+bool ConfigContentStore::IsManifestName(const std::string& name) {
+    if (name.empty() || name == "." || name == "..") return false;
+    // Separators (and a drive colon) would let the name reach outside manifests/.
+    return name.find_first_of(std::string("/\\:\0", 4)) == std::string::npos;
+}
+
+bool ConfigContentStore::IsBlobKey(const std::string& key) {
+    if (key.size() < 2) return false;
+    for (char c : key) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || c == '-')) return false;
+    }
+    return true;
+}
+
+fs::path ConfigContentStore::BlobPath(const std::string& hash) const {
+    return objects_dir_ / hash.substr(0, 2) / hash;
+}
+
+fs::path ConfigContentStore::ManifestPath(const std::string& name) const {
+    return manifests_dir_ / (name + kManifestExtension);
+}
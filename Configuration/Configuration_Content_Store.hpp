@@ -0,0 +1,59 @@
+#pragma once
+#include "Configuration_System.hpp"
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Content-addressed config storage.
+//
+//   <root>/objects/<hh>/<hash>[-n]   one component, binary encoded, written once
+//   <root>/manifests/<name>.manifest { "blobs": { "<component id>": "<hash>", ... } }
+//
+// Saving only writes blobs that aren't already stored plus the manifest; blobs no manifest
+// references are removed by CollectGarbage(). The hash isn't collision resistant, so a blob
+// only counts as stored when the bytes match; a different blob with the same hash gets the
+// next free -n suffix.
+class ConfigContentStore {
+public:
+    using ComponentState = ConfigSystem::ComponentState;
+
+    explicit ConfigContentStore(fs::path root);
+
+    // Creates the store directories and indexes the blobs already on disk.
+    bool Initialize();
+
+    bool Save(const std::string& name, const std::vector<ComponentState>& components, size_t* blobs_written = nullptr);
+    bool Load(const std::string& name, std::vector<ComponentState>& components);
+    std::vector<std::string> ListManifests() const;
+
+    // Removes unreferenced blobs, returns how many were deleted.
+    size_t CollectGarbage();
+
+    // 64-bit FNV-1a of the blob bytes, as 16 hex digits.
+    static std::string HashBlob(std::string_view data);
+
+private:
+    // A manifest name is a plain file name: no separators, not "." or "..".
+    static bool IsManifestName(const std::string& name);
+    // Hex digits and the -n suffix, as StoreBlob makes them; a manifest is read from disk.
+    static bool IsBlobKey(const std::string& key);
+    fs::path BlobPath(const std::string& hash) const;
+    // Only for names IsManifestName accepts.
+    fs::path ManifestPath(const std::string& name) const;
+    // Finds or writes the blob, returns its key or an empty string on a write error.
+    std::string StoreBlob(const std::string& blob, size_t& written);
+
+    const fs::path root_;
+    const fs::path objects_dir_;
+    const fs::path manifests_dir_;
+
+    std::mutex mutex_;
+    // Key -> bytes; empty until this run wrote the blob or compared against it.
+    std::unordered_map<std::string, std::string> known_blobs_;
+};
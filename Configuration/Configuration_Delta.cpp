@@ -0,0 +1,105 @@
+#include "Configuration_Delta.hpp"
+#include <fstream>
+#include <unordered_map>
+
+bool ConfigDelta::IsDeltaFile(const std::string& filename) {
+    std::string suffix = kSuffix;
+    return filename.size() > suffix.size() &&
+           filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+std::vector<ConfigDelta::ComponentPatch> ConfigDelta::Diff(const std::vector<ComponentState>& base, const std::vector<ComponentState>& target) {
+    std::unordered_map<std::string, const ComponentState*> index;
+    index.reserve(base.size());
+    for (const auto& s : base) index.emplace(s.id, &s);
+
+    std::vector<ComponentPatch> patches;
+    for (const auto& s : target) {
+        auto it = index.find(s.id);
+        std::uint32_t fields = it == index.end() ? ConfigSystem::Field_All : ConfigSystem::DiffComponent(*it->second, s);
+        if (fields != 0) patches.push_back({s.id, fields, s});
+    }
+    return patches;
+}
+
+void ConfigDelta::Apply(ComponentState& state, const ComponentPatch& patch) {
+    const ComponentState& v = patch.values;
+    if (patch.fields & ConfigSystem::Field_IsOpen) state.is_open = v.is_open;
+    if (patch.fields & ConfigSystem::Field_Position) state.position = v.position;
+    if (patch.fields & ConfigSystem::Field_Size) state.size = v.size;
+    if (patch.fields & ConfigSystem::Field_SliderFloat) state.slider_float = v.slider_float;
+    if (patch.fields & ConfigSystem::Field_SliderInt) state.slider_int = v.slider_int;
+    if (patch.fields & ConfigSystem::Field_Checkbox) state.checkbox = v.checkbox;
+    if (patch.fields & ConfigSystem::Field_Color) state.color = v.color;
+}
+
+std::vector<ConfigDelta::ComponentState> ConfigDelta::ApplyAll(std::vector<ComponentState>& components) const {
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(components.size());
+    for (size_t i = 0; i < components.size(); ++i) index.emplace(components[i].id, i);
+
+    std::vector<ComponentState> originals;
+    originals.reserve(patches.size());
+    for (const auto& patch : patches) {
+        auto [it, inserted] = index.try_emplace(patch.id, components.size());
+        if (inserted) {
+            ComponentState s;
+            s.id = patch.id;
+            components.push_back(std::move(s));
+        }
+        originals.push_back(components[it->second]);
+        Apply(components[it->second], patch);
+    }
+    return originals;
+}
+
+bool ConfigDelta::Read(const std::string& filename, std::string* error) {
+    try {
+        std::ifstream file(filename);
+        if (!file) throw std::runtime_error("cannot open " + filename);
+        json j;
+        file >> j;
+
+        base = j.at("base").get<std::string>();
+        if (IsDeltaFile(base)) throw std::runtime_error("delta base must be a full config: " + base);
+
+        patches.clear();
+        for (auto& [id, data] : j.at("delta").items()) {
+            ComponentPatch patch;
+            patch.id = id;
+            patch.values = ConfigSystem::DeserializeComponent(data);
+            patch.values.id = id;
+            if (data.contains("is_open")) patch.fields |= ConfigSystem::Field_IsOpen;
+            if (data.contains("position")) patch.fields |= ConfigSystem::Field_Position;
+            if (data.contains("size")) patch.fields |= ConfigSystem::Field_Size;
+            if (data.contains("slider_float")) patch.fields |= ConfigSystem::Field_SliderFloat;
+            if (data.contains("slider_int")) patch.fields |= ConfigSystem::Field_SliderInt;
+            if (data.contains("checkbox")) patch.fields |= ConfigSystem::Field_Checkbox;
+            if (data.contains("color")) patch.fields |= ConfigSystem::Field_Color;
+            patches.push_back(std::move(patch));
+        }
+        return true;
+    } catch (std::exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+}
+
+std::string ConfigDelta::Encode() const {
+    json j;
+    j["base"] = base;
+    j["delta"] = json::object();
+    for (const auto& patch : patches) {
+        const ComponentState& s = patch.values;
+        json& c = j["delta"][patch.id];
+        c = json::object();
+        if (patch.fields & ConfigSystem::Field_IsOpen) c["is_open"] = s.is_open;
+        if (patch.fields & ConfigSystem::Field_Position) c["position"] = {s.position.x, s.position.y};
+        if (patch.fields & ConfigSystem::Field_Size) c["size"] = {s.size.x, s.size.y};
+        if (patch.fields & ConfigSystem::Field_SliderFloat) c["slider_float"] = s.slider_float;
+        if (patch.fields & ConfigSystem::Field_SliderInt) c["slider_int"] = s.slider_int;
+        if (patch.fields & ConfigSystem::Field_Checkbox) c["checkbox"] = s.checkbox;
+        if (patch.fields & ConfigSystem::Field_Color) c["color"] = {s.color.x, s.color.y, s.color.z, s.color.w};
+    }
+    return j.dump(4);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Configuration_System.hpp"
+#include <string>
+#include <vector>
+
+// A config stored as the changes against a full base config.
+//
+//   { "base": "config_1700000000.json",
+//     "delta": { "Window1": { "position": [120, 80] }, ... } }
+//
+// Only the fields present under a component are applied. The base must be a full config.
+class ConfigDelta {
+public:
+    using ComponentState = ConfigSystem::ComponentState;
+    using ComponentPatch = ConfigSystem::ComponentPatch;
+
+    static constexpr const char* kSuffix = ".delta.json";
+
+    std::string base;
+    std::vector<ComponentPatch> patches;
+
+    static bool IsDeltaFile(const std::string& filename);
+
+    // Patches for every component in target that is new or differs from base.
+    static std::vector<ComponentPatch> Diff(const std::vector<ComponentState>& base, const std::vector<ComponentState>& target);
+    static void Apply(ComponentState& state, const ComponentPatch& patch);
+    // Applies all patches to a full component list, appending components the base doesn't have.
+    // Returns the pre-patch state of every patched component.
+    std::vector<ComponentState> ApplyAll(std::vector<ComponentState>& components) const;
+
+    bool Read(const std::string& filename, std::string* error = nullptr);
+    std::string Encode() const;
+};
@@ -0,0 +1,311 @@
+#include "Configuration_Directory_Index.hpp"
+#include "Configuration_Binary_Format.hpp"
+#include "Configuration_Delta.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+ConfigDirectoryIndex::Format DetectFormat(const fs::path& path) {
+    if (ConfigDelta::IsDeltaFile(path.filename().string()))
+        return ConfigDirectoryIndex::Format::Delta;
+
+    char magic[sizeof(ConfigBinaryFormat::kMagic)] = {};
+    std::ifstream file(path, std::ios::binary);
+    if (file.read(magic, sizeof(magic)) && std::memcmp(magic, ConfigBinaryFormat::kMagic, sizeof(magic)) == 0)
+        return ConfigDirectoryIndex::Format::Binary;
+    return ConfigDirectoryIndex::Format::Json;
+}
+
+} // namespace
+
+ConfigDirectoryIndex::ConfigDirectoryIndex(fs::path directory)
+    : directory_(std::move(directory)), snapshot_(std::make_shared<std::vector<Entry>>()) {}
+
+ConfigDirectoryIndex::~ConfigDirectoryIndex() {
+    Stop();
+}
+
+bool ConfigDirectoryIndex::IsConfigFile(const fs::path& path) {
+    auto ext = path.extension();
+    return ext == ".json" || ext == ConfigBinaryFormat::kExtension;
+}
+
+void ConfigDirectoryIndex::Start() {
+    if (running_) return;
+
+    Rescan();
+    Publish();
+    running_ = true;
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ >= 0) {
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (AddWatch() && wake_fd_ >= 0) {
+            watcher_ = std::thread(&ConfigDirectoryIndex::WatchLoop, this);
+            return;
+        }
+        close(inotify_fd_);
+        inotify_fd_ = -1;
+        if (wake_fd_ >= 0) close(wake_fd_);
+        wake_fd_ = -1;
+    }
+#endif
+    watcher_ = std::thread(&ConfigDirectoryIndex::PollLoop, this);
+}
+
+void ConfigDirectoryIndex::Stop() {
+    if (!running_.exchange(false)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_cv_.notify_all();
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        (void)!write(wake_fd_, &one, sizeof(one));
+    }
+#endif
+    if (watcher_.joinable()) watcher_.join();
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (inotify_fd_ >= 0) close(inotify_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    inotify_fd_ = -1;
+    wake_fd_ = -1;
+    watch_ = -1;
+#endif
+}
+
+ConfigDirectoryIndex::Snapshot ConfigDirectoryIndex::GetEntries() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return snapshot_;
+}
+
+std::optional<ConfigDirectoryIndex::Entry> ConfigDirectoryIndex::Find(const std::string& name) const {
+    Snapshot entries = GetEntries();
+    auto it = std::lower_bound(entries->begin(), entries->end(), name,
+                               [](const Entry& entry, const std::string& key) { return entry.name < key; });
+    if (it == entries->end() || it->name != name) return std::nullopt;
+    return *it;
+}
+
+bool ConfigDirectoryIndex::Covers(const std::string& path) const {
+    fs::path file = fs::path(path).lexically_normal();
+    fs::path parent = file.parent_path();
+    if (parent.empty()) parent = ".";
+    return parent == directory_.lexically_normal() && IsConfigFile(file);
+}
+
+void ConfigDirectoryIndex::Refresh() {
+    if (!running_) {
+        Rescan();
+        Publish();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        rescan_requested_ = true;
+    }
+    wake_cv_.notify_all();
+#if !defined(_WIN32) && !defined(_WIN64)
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        (void)!write(wake_fd_, &one, sizeof(one));
+    }
+#endif
+}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+
+bool ConfigDirectoryIndex::AddWatch() {
+    const uint32_t mask = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB |
+                          IN_DELETE_SELF | IN_MOVE_SELF;
+    watch_ = inotify_add_watch(inotify_fd_, directory_.c_str(), mask);
+    return watch_ >= 0;
+}
+
+void ConfigDirectoryIndex::WatchLoop() {
+    alignas(inotify_event) char buffer[16 * 1024];
+    std::unordered_set<std::string> touched;
+    std::vector<std::string> changed;
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+
+    while (running_) {
+        if (rescan_requested_.exchange(false)) {
+            Rescan();
+            Publish();
+        }
+        // The directory went away; once something is back at its path, watch and list that.
+        if (watch_ < 0 && AddWatch()) {
+            Rescan();
+            Publish();
+        }
+
+        if (poll(fds, 2, watch_ < 0 ? 1000 : -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            (void)!read(wake_fd_, &value, sizeof(value));
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        // Drain everything queued so a burst of writes to one file becomes a single stat.
+        bool overflow = false, lost = false;
+        ssize_t len;
+        while ((len = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                if (event->mask & IN_Q_OVERFLOW) overflow = true;
+                else if (event->wd == watch_ && (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))) lost = true;
+                else if (event->len > 0) touched.insert(event->name);
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        if (lost) {
+            // Deleted, nothing more will come from the watch; moved, it would follow the
+            // directory to wherever it went. Either way drop it and list what's at the path now.
+            inotify_rm_watch(inotify_fd_, watch_);
+            watch_ = -1;
+            overflow = true;
+        }
+
+        changed.clear();
+        if (overflow) {
+            Rescan();
+            Publish();
+        } else {
+            for (const auto& name : touched) {
+                if (UpdateEntry(name)) changed.push_back(name);
+            }
+            if (!changed.empty()) Publish(changed);
+        }
+        touched.clear();
+    }
+}
+
+#else
+
+void ConfigDirectoryIndex::WatchLoop() {
+    PollLoop();
+}
+
+#endif
+
+void ConfigDirectoryIndex::PollLoop() {
+    std::error_code ec;
+    auto dirTime = fs::last_write_time(directory_, ec);
+    std::vector<std::string> names, changed;
+
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_cv_.wait_for(lock, std::chrono::seconds(1), [this]() { return !running_ || rescan_requested_; });
+        }
+        if (!running_) break;
+
+        // Creates, deletes and renames bump the directory mtime; in-place writes only show on the file.
+        auto nowTime = fs::last_write_time(directory_, ec);
+        if (rescan_requested_.exchange(false) || nowTime != dirTime) {
+            dirTime = nowTime;
+            Rescan();
+            Publish();
+        } else {
+            names.clear();
+            changed.clear();
+            for (const auto& [name, entry] : entries_) names.push_back(name);
+            for (const auto& name : names) {
+                if (UpdateEntry(name)) changed.push_back(name);
+            }
+            if (!changed.empty()) Publish(changed);
+        }
+    }
+}
+
+void ConfigDirectoryIndex::Rescan() {
+    entries_.clear();
+    std::error_code ec;
+    for (auto it = fs::directory_iterator(directory_, ec); !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        if (IsConfigFile(it->path())) UpdateEntry(it->path().filename().string());
+    }
+}
+
+bool ConfigDirectoryIndex::UpdateEntry(const std::string& name) {
+    fs::path path = directory_ / name;
+    if (!IsConfigFile(path)) return false;
+
+    std::error_code ec;
+    auto status = fs::status(path, ec);
+    if (ec || !fs::is_regular_file(status)) return entries_.erase(name) > 0;
+
+    Entry entry;
+    entry.name = name;
+    entry.size = fs::file_size(path, ec);
+    entry.mtime = fs::last_write_time(path, ec);
+    if (ec) return entries_.erase(name) > 0;
+
+    auto it = entries_.find(name);
+    if (it != entries_.end() && it->second.size == entry.size && it->second.mtime == entry.mtime) return false;
+
+    entry.format = DetectFormat(path);
+    entries_[name] = std::move(entry);
+    return true;
+}
+
+void ConfigDirectoryIndex::Publish() {
+    auto entries = std::make_shared<std::vector<Entry>>();
+    entries->reserve(entries_.size());
+    for (const auto& [name, entry] : entries_) entries->push_back(entry);
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        snapshot_ = std::move(entries);
+    }
+    version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void ConfigDirectoryIndex::Publish(const std::vector<std::string>& names) {
+    std::unique_lock<std::mutex> lock(snapshot_mutex_);
+    // Readers only take a reference under this lock, so a sole owner here stays the sole owner.
+    if (snapshot_.use_count() != 1) {
+        lock.unlock();
+        Publish();
+        return;
+    }
+    // Pairs with the release of the last reader dropping its reference.
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    std::vector<Entry>& entries = *snapshot_;
+    for (const auto& name : names) {
+        auto it = std::lower_bound(entries.begin(), entries.end(), name,
+                                   [](const Entry& entry, const std::string& key) { return entry.name < key; });
+        bool listed = it != entries.end() && it->name == name;
+        auto current = entries_.find(name);
+        if (current == entries_.end()) {
+            if (listed) entries.erase(it);
+        } else if (listed) {
+            *it = current->second;
+        } else {
+            entries.insert(it, current->second);
+        }
+    }
+    lock.unlock();
+    version_.fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Keeps an in-memory listing of the config files in a directory. A watcher thread updates it
+// from inotify events (or by polling mtimes where inotify isn't available), so readers never
+// touch the filesystem. If the directory is deleted or moved away the listing empties and
+// fills again once a directory is back at the path.
+class ConfigDirectoryIndex {
+public:
+    enum class Format {
+        Json,
+        Binary,
+        Delta
+    };
+
+    struct Entry {
+        std::string name;
+        std::uintmax_t size = 0;
+        fs::file_time_type mtime;
+        Format format = Format::Json;
+    };
+
+    using Snapshot = std::shared_ptr<const std::vector<Entry>>;
+
+    explicit ConfigDirectoryIndex(fs::path directory = ".");
+    ~ConfigDirectoryIndex();
+
+    ConfigDirectoryIndex(const ConfigDirectoryIndex&) = delete;
+    ConfigDirectoryIndex& operator=(const ConfigDirectoryIndex&) = delete;
+
+    // Does the initial scan on the calling thread, then starts the watcher.
+    void Start();
+    void Stop();
+
+    // Sorted by name. Cheap enough to call every frame; let go of it afterwards, a snapshot a
+    // reader still holds makes the next change publish a full copy.
+    Snapshot GetEntries() const;
+    // Looks a file up in the current snapshot.
+    std::optional<Entry> Find(const std::string& name) const;
+    // Whether path names a config file directly in the indexed directory, so Find(filename)
+    // answers for it and its changes bump the version.
+    bool Covers(const std::string& path) const;
+    std::uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+    // Asks the watcher for a full rescan.
+    void Refresh();
+
+    static bool IsConfigFile(const fs::path& path);
+
+private:
+    void WatchLoop();
+    void PollLoop();
+    void Rescan();
+    // Re-stats a single file, returns true if the index changed.
+    bool UpdateEntry(const std::string& name);
+    // Hands entries_ to readers as a new snapshot.
+    void Publish();
+    // Publishes a change to the named entries only. The current snapshot is patched in place
+    // when no reader holds it, otherwise this falls back to a full Publish.
+    void Publish(const std::vector<std::string>& names);
+#if !defined(_WIN32) && !defined(_WIN64)
+    bool AddWatch();
+#endif
+
+    const fs::path directory_;
+    std::map<std::string, Entry> entries_; // owned by the watcher thread after Start()
+
+    mutable std::mutex snapshot_mutex_;
+    std::shared_ptr<std::vector<Entry>> snapshot_;
+    std::atomic<std::uint64_t> version_{0};
+
+    std::thread watcher_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> rescan_requested_{false};
+#if !defined(_WIN32) && !defined(_WIN64)
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;
+    int watch_ = -1; // -1 while the directory is gone
+#endif
+};
@@ -0,0 +1,108 @@
+#include "Configuration_Layers.hpp"
+#include "Configuration_Delta.hpp"
+#include <algorithm>
+
+ConfigLayerStack::LayerPtr ConfigLayerStack::MakeLayer(std::string name, std::string source, std::vector<ComponentPatch>&& patches) {
+    auto layer = std::make_shared<Layer>();
+    layer->name = std::move(name);
+    layer->source = std::move(source);
+    layer->components.reserve(patches.size());
+    for (auto& patch : patches) {
+        std::string id = patch.id;
+        layer->components[std::move(id)] = std::make_shared<const ComponentPatch>(std::move(patch));
+    }
+    return layer;
+}
+
+std::vector<std::string> ConfigLayerStack::GetOverlayNames() const {
+    std::vector<std::string> names;
+    names.reserve(overlays_.size());
+    for (const auto& [name, layer] : overlays_) names.push_back(name);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+std::vector<std::string> ConfigLayerStack::SetBase(LayerPtr base) {
+    std::vector<std::string> ids;
+    CollectIds(base_.get(), ids);
+    base_ = std::move(base);
+    CollectIds(base_.get(), ids);
+    CollectIds(ActiveOverlay(), ids);
+    CollectIds(user_.get(), ids);
+    return ids;
+}
+
+std::vector<std::string> ConfigLayerStack::AddOverlay(LayerPtr overlay) {
+    std::vector<std::string> ids;
+    bool active = overlay->name == active_overlay_;
+    if (active) CollectIds(ActiveOverlay(), ids);
+    overlays_[overlay->name] = overlay;
+    if (active) CollectIds(overlay.get(), ids);
+    return ids;
+}
+
+std::vector<std::string> ConfigLayerStack::SetActiveOverlay(const std::string& name) {
+    // Only components named by the old or the new overlay can resolve differently.
+    std::vector<std::string> ids;
+    CollectIds(ActiveOverlay(), ids);
+    active_overlay_ = overlays_.count(name) ? name : std::string();
+    CollectIds(ActiveOverlay(), ids);
+    return ids;
+}
+
+std::vector<std::string> ConfigLayerStack::SetUserPatch(const ComponentPatch& patch) {
+    auto next = user_ ? std::make_shared<Layer>(*user_) : std::make_shared<Layer>();
+    if (!user_) next->name = "user";
+
+    auto merged = std::make_shared<ComponentPatch>();
+    auto it = next->components.find(patch.id);
+    if (it != next->components.end()) *merged = *it->second;
+    merged->id = patch.id;
+    merged->values.id = patch.id;
+    ConfigDelta::Apply(merged->values, patch);
+    merged->fields |= patch.fields;
+
+    next->components[patch.id] = std::move(merged);
+    user_ = std::move(next);
+    return {patch.id};
+}
+
+std::vector<std::string> ConfigLayerStack::ClearUser() {
+    std::vector<std::string> ids;
+    CollectIds(user_.get(), ids);
+    user_.reset();
+    return ids;
+}
+
+void ConfigLayerStack::Reset() {
+    base_.reset();
+    user_.reset();
+    overlays_.clear();
+    active_overlay_.clear();
+}
+
+bool ConfigLayerStack::Resolve(const std::string& id, ComponentState& out) const {
+    out = ComponentState{};
+    out.id = id;
+
+    bool found = false;
+    for (const Layer* layer : {base_.get(), ActiveOverlay(), user_.get()}) {
+        if (!layer) continue;
+        auto it = layer->components.find(id);
+        if (it == layer->components.end()) continue;
+        ConfigDelta::Apply(out, *it->second);
+        found = true;
+    }
+    return found;
+}
+
+const ConfigLayerStack::Layer* ConfigLayerStack::ActiveOverlay() const {
+    if (active_overlay_.empty()) return nullptr;
+    auto it = overlays_.find(active_overlay_);
+    return it == overlays_.end() ? nullptr : it->second.get();
+}
+
+void ConfigLayerStack::CollectIds(const Layer* layer, std::vector<std::string>& ids) {
+    if (!layer) return;
+    for (const auto& [id, patch] : layer->components) ids.push_back(id);
+}
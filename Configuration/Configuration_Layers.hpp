@@ -0,0 +1,53 @@
+#pragma once
+#include "Configuration_System.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Base / overlay / user layering of config components.
+//
+// Layers are immutable and held by shared_ptr; a change builds a new layer that copies the
+// map of component pointers but shares every component it didn't touch. The base layer holds
+// full components, overlays and the user layer hold only the fields they override.
+class ConfigLayerStack {
+public:
+    using ComponentState = ConfigSystem::ComponentState;
+    using ComponentPatch = ConfigSystem::ComponentPatch;
+
+    struct Layer {
+        std::string name;
+        std::string source;
+        std::unordered_map<std::string, std::shared_ptr<const ComponentPatch>> components;
+    };
+    using LayerPtr = std::shared_ptr<const Layer>;
+
+    static LayerPtr MakeLayer(std::string name, std::string source, std::vector<ComponentPatch>&& patches);
+
+    bool HasBase() const { return base_ != nullptr; }
+    const LayerPtr& GetBase() const { return base_; }
+    const LayerPtr& GetUser() const { return user_; }
+    const std::string& GetActiveOverlay() const { return active_overlay_; }
+    std::vector<std::string> GetOverlayNames() const;
+
+    // Every setter returns the ids whose resolved state may have changed.
+    std::vector<std::string> SetBase(LayerPtr base);
+    std::vector<std::string> AddOverlay(LayerPtr overlay);
+    std::vector<std::string> SetActiveOverlay(const std::string& name);
+    std::vector<std::string> SetUserPatch(const ComponentPatch& patch);
+    std::vector<std::string> ClearUser();
+    void Reset();
+
+    // Base, then the active overlay, then the user layer. False, with out at defaults, if no
+    // layer has the component.
+    bool Resolve(const std::string& id, ComponentState& out) const;
+
+private:
+    const Layer* ActiveOverlay() const;
+    static void CollectIds(const Layer* layer, std::vector<std::string>& ids);
+
+    LayerPtr base_;
+    LayerPtr user_;
+    std::unordered_map<std::string, LayerPtr> overlays_;
+    std::string active_overlay_;
+};
@@ -0,0 +1,167 @@
+#include "Configuration_Stream_Loader.hpp"
+#include "../File/Mapped_File.hpp"
+#include <limits>
+
+namespace {
+
+using ComponentState = ConfigSystem::ComponentState;
+
+// Depth layout of a config document:
+//   1 root object, 2 "components" object, 3 one component, 4 array valued field
+class ComponentSaxHandler : public nlohmann::json_sax<json> {
+public:
+    explicit ComponentSaxHandler(const ConfigStreamLoader::ComponentSink& sink) : sink_(sink) {}
+
+    std::string error;
+
+    bool null() override { return Scalar(); }
+    bool boolean(bool val) override {
+        if (InComponentField()) {
+            if (field_ == Field::IsOpen) current_.is_open = val;
+            else if (field_ == Field::Checkbox) current_.checkbox = val;
+        }
+        return Scalar();
+    }
+    bool number_integer(number_integer_t val) override { return Number(static_cast<double>(val)); }
+    bool number_unsigned(number_unsigned_t val) override { return Number(static_cast<double>(val)); }
+    bool number_float(number_float_t val, const string_t&) override { return Number(val); }
+    bool string(string_t&) override { return Scalar(); }
+    bool binary(binary_t&) override { return Scalar(); }
+
+    bool start_object(std::size_t) override {
+        ++depth_;
+        if (depth_ == 2 && root_key_is_components_) {
+            in_components_ = true;
+        } else if (depth_ == 3 && in_components_) {
+            current_ = ComponentState{};
+            current_.id = component_key_; // the key is canonical, a nested "id" field is ignored
+            in_component_ = true;
+        }
+        field_ = Field::None;
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (depth_ == 1) {
+            root_key_is_components_ = (val == "components");
+        } else if (depth_ == 2 && in_components_) {
+            component_key_ = std::move(val);
+        } else if (depth_ == 3 && in_component_) {
+            field_ = LookupField(val);
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth_ == 3 && in_component_) {
+            in_component_ = false;
+            sink_(std::move(current_));
+        } else if (depth_ == 2) {
+            in_components_ = false;
+        }
+        --depth_;
+        field_ = Field::None;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth_;
+        if (depth_ == 4 && in_component_ &&
+            (field_ == Field::Position || field_ == Field::Size || field_ == Field::Color)) {
+            array_field_ = field_;
+            array_count_ = 0;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (depth_ == 4 && array_field_ != Field::None) {
+            // same rule as DeserializeComponent: wrong sized arrays keep the default
+            const float* a = array_;
+            if (array_field_ == Field::Position && array_count_ == 2) current_.position = ImVec2(a[0], a[1]);
+            else if (array_field_ == Field::Size && array_count_ == 2) current_.size = ImVec2(a[0], a[1]);
+            else if (array_field_ == Field::Color && array_count_ == 4) current_.color = ImVec4(a[0], a[1], a[2], a[3]);
+            array_field_ = Field::None;
+        }
+        --depth_;
+        field_ = Field::None;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        return false;
+    }
+
+private:
+    enum class Field { None, IsOpen, Position, Size, SliderFloat, SliderInt, Checkbox, Color };
+
+    static Field LookupField(const std::string& name) {
+        if (name == "is_open") return Field::IsOpen;
+        if (name == "position") return Field::Position;
+        if (name == "size") return Field::Size;
+        if (name == "slider_float") return Field::SliderFloat;
+        if (name == "slider_int") return Field::SliderInt;
+        if (name == "checkbox") return Field::Checkbox;
+        if (name == "color") return Field::Color;
+        return Field::None;
+    }
+
+    bool InComponentField() const { return depth_ == 3 && in_component_ && field_ != Field::None; }
+
+    bool Scalar() {
+        if (depth_ == 3) field_ = Field::None;
+        return true;
+    }
+
+    bool Number(double val) {
+        if (depth_ == 4 && array_field_ != Field::None) {
+            if (array_count_ < 4) array_[array_count_] = static_cast<float>(val);
+            ++array_count_;
+        } else if (InComponentField()) {
+            if (field_ == Field::SliderFloat) current_.slider_float = static_cast<float>(val);
+            else if (field_ == Field::SliderInt) current_.slider_int = SaturatedInt(val);
+        }
+        return Scalar();
+    }
+
+    // Casting a double outside int's range is undefined, so clamp first.
+    static int SaturatedInt(double val) {
+        constexpr double lowest = static_cast<double>((std::numeric_limits<int>::min)());
+        constexpr double highest = static_cast<double>((std::numeric_limits<int>::max)());
+        if (val <= lowest) return (std::numeric_limits<int>::min)();
+        if (val >= highest) return (std::numeric_limits<int>::max)();
+        return static_cast<int>(val);
+    }
+
+    const ConfigStreamLoader::ComponentSink& sink_;
+    int depth_ = 0;
+    bool root_key_is_components_ = false;
+    bool in_components_ = false;
+    bool in_component_ = false;
+    std::string component_key_;
+    ComponentState current_;
+    Field field_ = Field::None;
+    Field array_field_ = Field::None;
+    float array_[4] = {};
+    int array_count_ = 0;
+};
+
+} // namespace
+
+bool ConfigStreamLoader::LoadFile(const std::string& filename, const ComponentSink& sink, std::string* error) {
+    // Not mapped: a config rewritten in place while it is parsed would fault the mapping.
+    std::string data;
+    if (!readWholeFile(filename, data)) {
+        if (error) *error = "cannot open " + filename;
+        return false;
+    }
+    return LoadBuffer(data, sink, error);
+}
+
+bool ConfigStreamLoader::LoadBuffer(std::string_view data, const ComponentSink& sink, std::string* error) {
+    ComponentSaxHandler handler(sink);
+    bool ok = json::sax_parse(data.begin(), data.end(), &handler);
+    if (!ok && error) *error = handler.error;
+    return ok;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include "Configuration_System.hpp"
+#include <functional>
+#include <string>
+#include <string_view>
+
+// SAX based config reader. Walks the "components" object of a config and hands each
+// component to the sink as soon as its closing brace is seen, without building a json DOM.
+class ConfigStreamLoader {
+public:
+    using ComponentSink = std::function<void(ConfigSystem::ComponentState&&)>;
+
+    // Reads the file into one buffer and parses it there.
+    static bool LoadFile(const std::string& filename, const ComponentSink& sink, std::string* error = nullptr);
+
+    // Parses an in-memory document, used by LoadFile and for data that is already resident.
+    static bool LoadBuffer(std::string_view data, const ComponentSink& sink, std::string* error = nullptr);
+};
@@ -1,86 +1,891 @@
 #include "configuration_system.hpp"
-#include <iostream>
+#include "Configuration_Stream_Loader.hpp"
+#include "Configuration_Binary_Format.hpp"
+#include "Configuration_Delta.hpp"
+#include "Configuration_Layers.hpp"
+#include "../File/Log_Modules.hpp"
+#include "../File/Mapped_File.hpp"
+#include <algorithm>
+#include <atomic>
 
-namespace fs = std::filesystem;
+#if defined(_WIN32) || defined(_WIN64)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+ConfigSystem::ConfigSystem() : layers_(std::make_unique<ConfigLayerStack>()) {}
+
+ConfigSystem::~ConfigSystem() {
+    {
+        std::lock_guard<std::mutex> lock(save_mutex_);
+        stop_saver_ = true;
+    }
+    save_cv_.notify_all();
+    if (save_thread_.joinable()) save_thread_.join();
+
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        stop_loader_ = true;
+    }
+    load_cv_.notify_all();
+    if (load_thread_.joinable()) load_thread_.join();
+
+    config_index_.Stop();
+}
 
 bool ConfigSystem::Initialize(ID3D11Device*, ID3D11DeviceContext*) {
     // You can use device/context for texture saving later if needed
     is_initialized_ = true;
-    config_files_ = GetConfigFiles();
+    config_index_.Start();
     return true;
 }
 
-void ConfigSystem::AddComponent(const std::string& id) {
-    if (components_.count(id) == 0) {
+ConfigSystem::ComponentId ConfigSystem::AddComponent(const std::string& id) {
+    return InternComponent(id);
+}
+
+std::optional<ConfigSystem::ComponentId> ConfigSystem::FindComponent(const std::string& id) const {
+    auto it = component_ids_.find(id);
+    if (it == component_ids_.end()) return std::nullopt;
+    return it->second;
+}
+
+const ConfigSystem::ComponentState* ConfigSystem::GetComponent(const std::string& id) const {
+    auto found = FindComponent(id);
+    return found ? &components_[*found] : nullptr;
+}
+
+ConfigSystem::ComponentId ConfigSystem::InternComponent(const std::string& id) {
+    auto [it, inserted] = component_ids_.try_emplace(id, static_cast<ComponentId>(components_.size()));
+    if (inserted) {
         ComponentState state;
         state.id = id;
-        components_[id] = state;
+        components_.push_back(std::move(state));
+        dirty_fields_.push_back(Field_All);
+        dirty_list_.push_back(it->second);
+        snapshot_stale_flags_.push_back(false); // new ids are past the end of the snapshot anyway
+    }
+    return it->second;
+}
+
+std::uint32_t ConfigSystem::AssignComponent(ComponentId id, const ComponentState& state) {
+    ComponentState& current = components_[id];
+    std::uint32_t changed = DiffComponent(current, state);
+    if (changed == 0) return 0;
+
+    if (changed & Field_IsOpen) current.is_open = state.is_open;
+    if (changed & Field_Position) current.position = state.position;
+    if (changed & Field_Size) current.size = state.size;
+    if (changed & Field_SliderFloat) current.slider_float = state.slider_float;
+    if (changed & Field_SliderInt) current.slider_int = state.slider_int;
+    if (changed & Field_Checkbox) current.checkbox = state.checkbox;
+    if (changed & Field_Color) current.color = state.color;
+
+    if (dirty_fields_[id] == 0) dirty_list_.push_back(id);
+    dirty_fields_[id] |= changed;
+    if (!snapshot_stale_flags_[id]) {
+        snapshot_stale_flags_[id] = true;
+        snapshot_stale_.push_back(id);
+    }
+    return changed;
+}
+
+void ConfigSystem::SetComponent(ComponentId id, const ComponentState& state) {
+    if (!layers_->HasBase()) {
+        AssignComponent(id, state);
+        return;
+    }
+    // The live state is resolved from the layers; assigned directly, the edit would be lost the
+    // next time the component is resolved.
+    std::uint32_t changed = DiffComponent(components_[id], state);
+    if (changed == 0) return;
+    ComponentPatch patch{components_[id].id, changed, state};
+    patch.values.id = patch.id;
+    SetUserOverride(patch);
+}
+
+std::uint32_t ConfigSystem::DiffComponent(const ComponentState& a, const ComponentState& b) {
+    std::uint32_t changed = 0;
+    if (a.is_open != b.is_open) changed |= Field_IsOpen;
+    if (a.position.x != b.position.x || a.position.y != b.position.y) changed |= Field_Position;
+    if (a.size.x != b.size.x || a.size.y != b.size.y) changed |= Field_Size;
+    if (a.slider_float != b.slider_float) changed |= Field_SliderFloat;
+    if (a.slider_int != b.slider_int) changed |= Field_SliderInt;
+    if (a.checkbox != b.checkbox) changed |= Field_Checkbox;
+    if (a.color.x != b.color.x || a.color.y != b.color.y || a.color.z != b.color.z || a.color.w != b.color.w)
+        changed |= Field_Color;
+    return changed;
+}
+
+bool ConfigSystem::SaveConfig(const std::string& filename, ConfigFormat format) {
+    std::string data, error;
+    if (!EncodeComponents(components_, format, data, &error)) {
+        RLOG_ERROR(ConfigSystem, "Failed to save config: {}", error);
+        return false;
+    }
+    if (!WriteConfigFile(filename, data))
+        return false;
+
+    current_config_file_ = filename;
+    return true;
+}
+
+void ConfigSystem::SaveConfigAsync(const std::string& filename, ConfigFormat format) {
+    SaveRequest request;
+    request.filename = filename;
+    request.format = format;
+    QueueSave(std::move(request));
+}
+
+bool ConfigSystem::ConvertConfig(const std::string& input, const std::string& output, ConfigFormat format) {
+    std::vector<ComponentState> components;
+    std::string error;
+    if (!ReadComponents(input, [&](ComponentState&& state) { components.push_back(std::move(state)); }, &error)) {
+        RLOG_ERROR(ConfigSystem, "Failed to convert config: {}", error);
+        return false;
+    }
+    std::string data;
+    if (!EncodeComponents(components, format, data, &error)) {
+        RLOG_ERROR(ConfigSystem, "Failed to convert config: {}", error);
+        return false;
+    }
+    return WriteConfigFile(output, data);
+}
+
+bool ConfigSystem::SaveDelta(const std::string& filename, const std::string& base_filename) {
+    std::string data, error;
+    std::vector<ComponentState> originals;
+    if (!BuildDelta(base_filename, components_, data, originals, &error)) {
+        RLOG_ERROR(ConfigSystem, "Failed to save config: {}", error);
+        return false;
+    }
+    if (!WriteConfigFile(filename, data))
+        return false;
+
+    current_config_file_ = filename;
+    SetActiveDelta(base_filename, std::move(originals));
+    return true;
+}
+
+void ConfigSystem::SaveDeltaAsync(const std::string& filename, const std::string& base_filename) {
+    SaveRequest request;
+    request.filename = filename;
+    request.delta_base = base_filename;
+    QueueSave(std::move(request));
+}
+
+void ConfigSystem::QueueSave(SaveRequest&& request) {
+    std::string filename = request.filename;
+    bool saver_busy;
+    {
+        std::lock_guard<std::mutex> lock(save_mutex_);
+        saver_busy = save_in_flight_ || !pending_saves_.empty();
+    }
+    // Only this thread queues saves, so an idle saver stays idle until the request is queued.
+    request.components = SnapshotComponents(saver_busy);
+    {
+        std::lock_guard<std::mutex> lock(save_mutex_);
+        // Only a save of the same file that hasn't started yet is superseded; other files keep theirs.
+        auto same = std::find_if(pending_saves_.begin(), pending_saves_.end(),
+                                 [&](const SaveRequest& pending) { return pending.filename == filename; });
+        if (same != pending_saves_.end()) *same = std::move(request);
+        else pending_saves_.push_back(std::move(request));
+        if (!save_thread_.joinable())
+            save_thread_ = std::thread(&ConfigSystem::SaveWorker, this);
+    }
+    save_cv_.notify_one();
+    save_status_ = "Saving " + filename + "...";
+}
+
+bool ConfigSystem::ApplyDelta(const std::string& filename) {
+    ConfigDelta delta;
+    std::string error;
+    if (!delta.Read(filename, &error)) {
+        RLOG_ERROR(ConfigSystem, "Failed to apply delta: {}", error);
+        return false;
+    }
+
+    for (const auto& patch : delta.patches) {
+        ComponentId id = InternComponent(patch.id);
+        ComponentState target = components_[id];
+        ConfigDelta::Apply(target, patch);
+        AssignComponent(id, target);
+    }
+    return true;
+}
+
+bool ConfigSystem::IsSaving() {
+    std::lock_guard<std::mutex> lock(save_mutex_);
+    return save_in_flight_ || !pending_saves_.empty();
+}
+
+void ConfigSystem::SaveWorker() {
+    std::unique_lock<std::mutex> lock(save_mutex_);
+    while (true) {
+        save_cv_.wait(lock, [this]() { return !pending_saves_.empty() || stop_saver_; });
+        if (pending_saves_.empty()) break; // stopping with nothing left to write
+
+        SaveRequest request = std::move(pending_saves_.front());
+        pending_saves_.pop_front();
+        save_in_flight_ = true;
+        lock.unlock();
+
+        SaveResult result;
+        result.filename = request.filename;
+        if (request.delta_base.empty()) {
+            std::string data, error;
+            result.ok = EncodeComponents(*request.components, request.format, data, &error);
+            if (result.ok)
+                result.ok = WriteConfigFile(request.filename, data);
+            else
+                RLOG_ERROR(ConfigSystem, "Failed to save config: {}", error);
+        } else {
+            std::string data, error;
+            result.delta_base = request.delta_base;
+            result.ok = BuildDelta(request.delta_base, *request.components, data, result.delta_originals, &error);
+            if (result.ok)
+                result.ok = WriteConfigFile(request.filename, data);
+            else
+                RLOG_ERROR(ConfigSystem, "Failed to save config: {}", error);
+        }
+
+        lock.lock();
+        finished_save_ = std::move(result);
+        save_in_flight_ = false;
     }
 }
 
-bool ConfigSystem::SaveConfig(const std::string& filename) {
+void ConfigSystem::PollSaveResults() {
+    std::optional<SaveResult> result;
+    {
+        std::lock_guard<std::mutex> lock(save_mutex_);
+        if (!finished_save_) return;
+        result = std::move(finished_save_);
+        finished_save_.reset();
+        if (save_in_flight_ || !pending_saves_.empty()) return; // a newer save supersedes this one
+    }
+
+    if (result->ok) {
+        current_config_file_ = result->filename;
+        if (result->delta_base.empty())
+            active_delta_.reset();
+        else
+            SetActiveDelta(result->delta_base, std::move(result->delta_originals));
+        save_status_ = "Saved " + result->filename;
+    } else {
+        save_status_ = "Failed to save " + result->filename;
+    }
+}
+
+std::shared_ptr<const std::vector<ConfigSystem::ComponentState>> ConfigSystem::SnapshotComponents(bool saver_busy) {
+    // The saver only reads a snapshot while it is queued or in flight. Otherwise the last one is
+    // brought up to date in place: just the components changed since, plus any added.
+    if (!snapshot_ || saver_busy) {
+        snapshot_ = std::make_shared<std::vector<ComponentState>>(components_);
+    } else {
+        std::vector<ComponentState>& snapshot = *snapshot_;
+        for (ComponentId id : snapshot_stale_) {
+            if (id < snapshot.size()) snapshot[id] = components_[id];
+        }
+        snapshot.insert(snapshot.end(), components_.begin() + snapshot.size(), components_.end());
+    }
+    for (ComponentId id : snapshot_stale_) snapshot_stale_flags_[id] = false;
+    snapshot_stale_.clear();
+    return snapshot_;
+}
+
+bool ConfigSystem::EncodeComponents(const std::vector<ComponentState>& components, ConfigFormat format, std::string& out, std::string* error) {
+    if (format == ConfigFormat::Binary)
+        return ConfigBinaryFormat::Encode(components, out, error);
+
     json j;
-    for (const auto& [id, state] : components_) {
-        j["components"][id] = SerializeComponent(state);
+    j["components"] = json::object();
+    for (const auto& state : components) {
+        j["components"][state.id] = SerializeComponent(state);
+    }
+    out = j.dump(4);
+    return true;
+}
+
+bool ConfigSystem::ReadComponents(const std::string& filename, const std::function<void(ComponentState&&)>& sink, std::string* error) {
+    if (ConfigDelta::IsDeltaFile(filename)) {
+        ConfigDelta delta;
+        std::vector<ComponentState> components;
+        if (!delta.Read(filename, error)) return false;
+        if (!ReadComponents(delta.base, [&](ComponentState&& state) { components.push_back(std::move(state)); }, error))
+            return false;
+        delta.ApplyAll(components);
+        for (auto& state : components) sink(std::move(state));
+        return true;
     }
 
+    // Read rather than mapped: editors often rewrite a config in place, and hot reload picks it
+    // up right then; a mapping truncated under the parser would fault.
+    std::string data;
+    if (!readWholeFile(filename, data)) {
+        if (error) *error = "cannot open " + filename;
+        return false;
+    }
+
+    if (ConfigBinaryFormat::IsBinary(data))
+        return ConfigBinaryFormat::Decode(data, sink, error);
+    return ConfigStreamLoader::LoadBuffer(data, sink, error);
+}
+
+bool ConfigSystem::WriteConfigFile(const std::string& filename, const std::string& data) {
+    // Write next to the target and rename over it so readers never see a half written file.
+    // The temp name is unique per call: a synchronous save racing the saver thread (or another
+    // process) on the same file must not truncate the other's temp file.
+    static std::atomic<std::uint64_t> temp_counter{0};
+#if defined(_WIN32) || defined(_WIN64)
+    long pid = _getpid();
+#else
+    long pid = static_cast<long>(getpid());
+#endif
+    std::string temp = filename + "." + std::to_string(pid) + "." +
+                       std::to_string(temp_counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
     try {
-        std::ofstream file(filename);
-        file << j.dump(4);
-        file.close();
-        config_files_ = GetConfigFiles(); // refresh
-        current_config_file_ = filename;
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file) throw std::runtime_error("cannot open " + temp);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            file.flush();
+            if (!file) throw std::runtime_error("write to " + temp + " failed");
+        }
+        fs::rename(temp, filename);
         return true;
     } catch (std::exception& e) {
-        std::cerr << "Failed to save config: " << e.what() << std::endl;
+        RLOG_ERROR(ConfigSystem, "Failed to save config: {}", e.what());
+        std::error_code ec;
+        fs::remove(temp, ec);
         return false;
     }
 }
 
+bool ConfigSystem::BuildDelta(const std::string& base_filename, const std::vector<ComponentState>& components,
+                              std::string& data, std::vector<ComponentState>& originals, std::string* error) {
+    std::vector<ComponentState> base;
+    if (!ReadComponents(base_filename, [&](ComponentState&& state) { base.push_back(std::move(state)); }, error))
+        return false;
+
+    ConfigDelta delta;
+    delta.base = base_filename;
+    delta.patches = ConfigDelta::Diff(base, components);
+    data = delta.Encode();
+    originals = delta.ApplyAll(base);
+    return true;
+}
+
 bool ConfigSystem::LoadConfig(const std::string& filename) {
-    try {
-        std::ifstream file(filename);
-        json j;
-        file >> j;
-        file.close();
+    std::string error;
+    bool ok;
+    if (ConfigDelta::IsDeltaFile(filename)) {
+        ok = LoadDelta(filename, &error);
+    } else {
+        // Parsed straight out of the file buffer with no DOM, but only assigned once the whole
+        // file parsed, so a bad file leaves the live config untouched.
+        std::vector<ComponentState> components;
+        ok = ReadComponents(filename, [&](ComponentState&& state) { components.push_back(std::move(state)); }, &error);
+        if (ok) {
+            for (const auto& state : components) {
+                AssignComponent(InternComponent(state.id), state);
+            }
+            active_delta_.reset();
+        }
+    }
+    if (ok) layers_->Reset();
 
-        for (auto& [id, data] : j["components"].items()) {
-            components_[id] = DeserializeComponent(data);
+    if (!ok) {
+        RLOG_ERROR(ConfigSystem, "Failed to load config: {}", error);
+        return false;
+    }
+    {
+        // Supersedes any async load still on its way.
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        installed_generation_ = ++load_generation_;
+        pending_load_.reset();
+    }
+    current_config_file_ = filename;
+    return true;
+}
+
+bool ConfigSystem::LoadDelta(const std::string& filename, std::string* error) {
+    ConfigDelta delta;
+    if (!delta.Read(filename, error)) return false;
+
+    bool on_base = active_delta_ ? active_delta_->base == delta.base : current_config_file_ == delta.base;
+    if (on_base) return SwitchDelta(delta, error);
+
+    std::vector<ComponentState> components;
+    if (!ReadComponents(delta.base, [&](ComponentState&& state) { components.push_back(std::move(state)); }, error))
+        return false;
+
+    auto originals = delta.ApplyAll(components);
+    for (const auto& state : components) {
+        AssignComponent(InternComponent(state.id), state);
+    }
+    SetActiveDelta(delta.base, std::move(originals));
+    return true;
+}
+
+bool ConfigSystem::SwitchDelta(const ConfigDelta& delta, std::string* error) {
+    // The live state is base + the previous delta; only components named by either one can differ.
+    std::unordered_map<ComponentId, ComponentState> previous;
+    if (active_delta_) previous = active_delta_->base_states;
+
+    // Base values the previous delta didn't record come from the base file, not the live
+    // components, which may have been edited since the base was loaded.
+    ActiveDelta next;
+    next.base = delta.base;
+    std::unordered_map<std::string, ComponentId> missing;
+    for (const auto& patch : delta.patches) {
+        ComponentId id = InternComponent(patch.id);
+        auto it = previous.find(id);
+        if (it != previous.end()) {
+            next.base_states.emplace(id, it->second);
+        } else {
+            ComponentState state;
+            state.id = patch.id; // defaults, as ApplyAll gives a component the base lacks
+            next.base_states.emplace(id, std::move(state));
+            missing.emplace(patch.id, id);
         }
-        current_config_file_ = filename;
-        return true;
-    } catch (std::exception& e) {
-        std::cerr << "Failed to load config: " << e.what() << std::endl;
+    }
+    if (!missing.empty()) {
+        bool ok = ReadComponents(delta.base, [&](ComponentState&& state) {
+            auto it = missing.find(state.id);
+            if (it != missing.end()) next.base_states[it->second] = std::move(state);
+        }, error);
+        if (!ok) return false;
+    }
+
+    for (const auto& [id, base_state] : previous) {
+        if (next.base_states.count(id) == 0)
+            AssignComponent(id, base_state);
+    }
+
+    for (const auto& patch : delta.patches) {
+        ComponentId id = component_ids_[patch.id];
+        ComponentState target = next.base_states[id];
+        ConfigDelta::Apply(target, patch);
+        AssignComponent(id, target);
+    }
+    active_delta_ = std::move(next);
+    return true;
+}
+
+void ConfigSystem::SetActiveDelta(const std::string& base, std::vector<ComponentState>&& originals) {
+    ActiveDelta active;
+    active.base = base;
+    for (auto& state : originals) {
+        ComponentId id = InternComponent(state.id);
+        active.base_states.emplace(id, std::move(state));
+    }
+    active_delta_ = std::move(active);
+}
+
+std::string ConfigSystem::DeltaBase() const {
+    if (active_delta_) return active_delta_->base;
+    return current_config_file_;
+}
+
+bool ConfigSystem::ReadConfig(const std::string& filename, LoadedConfig& out, std::optional<WatchStamp>* stamp) const {
+    out.filename = filename;
+    auto push = [&](ComponentState&& state) { out.components.push_back(std::move(state)); };
+
+    // Each file is stamped before it is read, so an edit landing mid-read leaves a stamp older
+    // than the contents: that costs a reread later, never a stale cache hit.
+    std::optional<WatchStamp> before = StampFiles(filename, std::string());
+    if (ConfigDelta::IsDeltaFile(filename)) {
+        ConfigDelta delta;
+        out.ok = delta.Read(filename, &out.error);
+        if (out.ok) {
+            if (auto base = StampFiles(delta.base, std::string()); base && before) {
+                before->size[1] = base->size[0];
+                before->mtime[1] = base->mtime[0];
+            }
+            out.ok = ReadComponents(delta.base, push, &out.error);
+        }
+        if (out.ok) {
+            out.delta_base = delta.base;
+            out.delta_originals = delta.ApplyAll(out.components);
+        }
+    } else {
+        out.ok = ReadComponents(filename, push, &out.error);
+    }
+
+    if (stamp) {
+        auto after = out.ok ? StampFiles(filename, out.delta_base) : std::nullopt;
+        if (before && after && *before == *after) *stamp = before;
+        else stamp->reset();
+    }
+    return out.ok;
+}
+
+void ConfigSystem::InstallConfig(const LoadedConfig& config, bool reload) {
+    if (reload && layers_->HasBase() && config.delta_base.empty() && config.filename == layers_->GetBase()->source) {
+        std::vector<ComponentPatch> patches;
+        patches.reserve(config.components.size());
+        for (const auto& state : config.components) patches.push_back({state.id, Field_All, state});
+        ApplyLayerChanges(layers_->SetBase(ConfigLayerStack::MakeLayer("base", config.filename, std::move(patches))));
+        RLOG_DEBUG(ConfigSystem, "Reloaded base layer {}", config.filename);
+        return;
+    }
+
+    // Field-by-field assignment, so only components that really changed get reapplied.
+    for (const auto& state : config.components) {
+        AssignComponent(InternComponent(state.id), state);
+    }
+    if (config.delta_base.empty())
+        active_delta_.reset();
+    else
+        SetActiveDelta(config.delta_base, std::vector<ComponentState>(config.delta_originals));
+    layers_->Reset();
+    current_config_file_ = config.filename;
+    RLOG_DEBUG(ConfigSystem, "Installed {} components from {}", config.components.size(), config.filename);
+}
+
+void ConfigSystem::LoadConfigAsync(const std::string& filename) {
+    RequestLoad(filename, true);
+}
+
+void ConfigSystem::PrefetchConfig(const std::string& filename) {
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        if (FindCached(filename)) return;
+        for (const auto& queued : prefetch_queue_) {
+            if (queued == filename) return;
+        }
+        prefetch_queue_.push_back(filename);
+        if (!load_thread_.joinable())
+            load_thread_ = std::thread(&ConfigSystem::LoadWorker, this);
+    }
+    load_cv_.notify_one();
+}
+
+void ConfigSystem::RequestLoad(const std::string& filename, bool user_request) {
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        if (user_request) {
+            ++load_generation_;
+            if (auto cached = FindCached(filename)) {
+                finished_load_ = std::move(cached); // already parsed, installs next frame
+                finished_generation_ = load_generation_;
+                pending_load_.reset();
+                return;
+            }
+        } else if (pending_load_ || installed_generation_ != load_generation_) {
+            return; // the user's pick is still on its way and replaces this file anyway
+        }
+        pending_load_ = filename; // a newer request replaces one that hasn't started
+        pending_generation_ = load_generation_;
+        if (!load_thread_.joinable())
+            load_thread_ = std::thread(&ConfigSystem::LoadWorker, this);
+    }
+    load_cv_.notify_one();
+}
+
+void ConfigSystem::LoadWorker() {
+    std::unique_lock<std::mutex> lock(load_mutex_);
+    while (true) {
+        load_cv_.wait(lock, [this]() { return pending_load_.has_value() || !prefetch_queue_.empty() || stop_loader_; });
+        if (stop_loader_) break;
+
+        // Real loads always go ahead of prefetches.
+        bool prefetch = !pending_load_;
+        std::string filename;
+        std::uint64_t generation = pending_generation_;
+        if (prefetch) {
+            filename = std::move(prefetch_queue_.front());
+            prefetch_queue_.pop_front();
+            if (FindCached(filename)) continue;
+        } else {
+            filename = std::move(*pending_load_);
+            pending_load_.reset();
+        }
+        lock.unlock();
+
+        auto config = std::make_shared<LoadedConfig>();
+        std::optional<WatchStamp> stamp;
+        ReadConfig(filename, *config, &stamp);
+
+        lock.lock();
+        if (stamp) {
+            prefetch_cache_.remove_if([&](const CachedConfig& cached) { return cached.filename == filename; });
+            prefetch_cache_.push_front({filename, *stamp, config});
+            if (prefetch_cache_.size() > kPrefetchCacheSize) prefetch_cache_.pop_back();
+        }
+        // A load that was overtaken by a newer request while it ran is only worth caching.
+        if (!prefetch && generation == load_generation_) {
+            finished_load_ = std::move(config);
+            finished_generation_ = generation;
+        }
+    }
+}
+
+void ConfigSystem::PollLoadResults() {
+    std::shared_ptr<const LoadedConfig> config;
+    bool reload = false;
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        if (!finished_load_) return;
+        config = std::move(finished_load_);
+        if (finished_generation_ != load_generation_) return;
+        // A hot reload runs in the generation that is already installed.
+        reload = finished_generation_ == installed_generation_;
+        installed_generation_ = finished_generation_;
+    }
+
+    if (!config->ok) {
+        RLOG_ERROR(ConfigSystem, "Failed to load config: {}", config->error);
+        return;
+    }
+
+    std::string previous = current_config_file_;
+    InstallConfig(*config, reload);
+    if (!previous.empty() && previous != current_config_file_)
+        PrefetchConfig(previous); // switching back is the most likely next pick
+}
+
+std::shared_ptr<const ConfigSystem::LoadedConfig> ConfigSystem::FindCached(const std::string& filename) {
+    for (auto it = prefetch_cache_.begin(); it != prefetch_cache_.end(); ++it) {
+        if (it->filename != filename) continue;
+
+        auto stamp = StampFiles(filename, it->config->delta_base);
+        if (!stamp || !(*stamp == it->stamp)) {
+            prefetch_cache_.erase(it); // changed on disk since it was read
+            return nullptr;
+        }
+        prefetch_cache_.splice(prefetch_cache_.begin(), prefetch_cache_, it);
+        return prefetch_cache_.front().config;
+    }
+    return nullptr;
+}
+
+void ConfigSystem::LoadComponents(const std::vector<ComponentState>& components) {
+    for (const auto& state : components) {
+        AssignComponent(InternComponent(state.id), state);
+    }
+    active_delta_.reset();
+    layers_->Reset();
+    current_config_file_.clear();
+}
+
+bool ConfigSystem::LoadBaseLayer(const std::string& filename) {
+    std::vector<ComponentPatch> patches;
+    std::string error;
+    bool ok = ReadComponents(filename, [&](ComponentState&& state) {
+        std::string id = state.id;
+        patches.push_back({std::move(id), Field_All, std::move(state)});
+    }, &error);
+    if (!ok) {
+        RLOG_ERROR(ConfigSystem, "Failed to load base layer: {}", error);
+        return false;
+    }
+
+    ApplyLayerChanges(layers_->SetBase(ConfigLayerStack::MakeLayer("base", filename, std::move(patches))));
+    active_delta_.reset();
+    current_config_file_ = filename;
+    return true;
+}
+
+bool ConfigSystem::LoadOverlay(const std::string& name, const std::string& filename) {
+    if (!layers_->HasBase()) {
+        RLOG_ERROR(ConfigSystem, "Failed to load overlay: no base layer");
         return false;
     }
+
+    std::vector<ComponentPatch> patches;
+    std::string error;
+    if (ConfigDelta::IsDeltaFile(filename)) {
+        ConfigDelta delta;
+        if (!delta.Read(filename, &error)) {
+            RLOG_ERROR(ConfigSystem, "Failed to load overlay: {}", error);
+            return false;
+        }
+        // Its patches only mean something on top of the base they were taken against.
+        if (delta.base != layers_->GetBase()->source) {
+            RLOG_ERROR(ConfigSystem, "Failed to load overlay: {} is a delta of {}, not of the base layer {}",
+                       filename, delta.base, layers_->GetBase()->source);
+            return false;
+        }
+        patches = std::move(delta.patches);
+    } else {
+        std::vector<ComponentState> base, overlay;
+        for (const auto& [id, patch] : layers_->GetBase()->components) base.push_back(patch->values);
+        if (!ReadComponents(filename, [&](ComponentState&& state) { overlay.push_back(std::move(state)); }, &error)) {
+            RLOG_ERROR(ConfigSystem, "Failed to load overlay: {}", error);
+            return false;
+        }
+        patches = ConfigDelta::Diff(base, overlay); // keep only what the overlay changes
+    }
+
+    ApplyLayerChanges(layers_->AddOverlay(ConfigLayerStack::MakeLayer(name, filename, std::move(patches))));
+    return true;
+}
+
+bool ConfigSystem::SetActiveOverlay(const std::string& name) {
+    if (!layers_->HasBase()) return false;
+    ApplyLayerChanges(layers_->SetActiveOverlay(name));
+    return layers_->GetActiveOverlay() == name;
+}
+
+void ConfigSystem::SetUserOverride(const ComponentPatch& patch) {
+    ApplyLayerChanges(layers_->SetUserPatch(patch));
+}
+
+bool ConfigSystem::SaveUserLayer(const std::string& filename) {
+    if (!layers_->HasBase()) return false;
+
+    ConfigDelta delta;
+    delta.base = layers_->GetBase()->source;
+    if (const auto& user = layers_->GetUser()) {
+        for (const auto& [id, patch] : user->components) delta.patches.push_back(*patch);
+    }
+    return WriteConfigFile(filename, delta.Encode());
+}
+
+void ConfigSystem::ApplyLayerChanges(const std::vector<std::string>& ids) {
+    ComponentState resolved;
+    for (const auto& id : ids) {
+        // An id no layer names any more resolves to defaults instead of keeping its stale value.
+        layers_->Resolve(id, resolved);
+        AssignComponent(InternComponent(id), resolved);
+    }
+}
+
+bool ConfigSystem::WatchStamp::operator==(const WatchStamp& other) const {
+    return size[0] == other.size[0] && size[1] == other.size[1] &&
+           mtime[0] == other.mtime[0] && mtime[1] == other.mtime[1];
+}
+
+ConfigSystem::WatchStamp ConfigSystem::CurrentWatchStamp() const {
+    return StampFiles(current_config_file_, active_delta_ ? active_delta_->base : std::string()).value_or(WatchStamp{});
+}
+
+std::optional<ConfigSystem::WatchStamp> ConfigSystem::StampFiles(const std::string& filename, const std::string& base) const {
+    WatchStamp stamp;
+    if (!StampFile(filename, stamp.size[0], stamp.mtime[0])) return std::nullopt;
+    if (!base.empty() && !StampFile(base, stamp.size[1], stamp.mtime[1])) {
+        stamp.size[1] = 0;
+        stamp.mtime[1] = fs::file_time_type();
+    }
+    return stamp;
+}
+
+bool ConfigSystem::StampFile(const std::string& filename, std::uintmax_t& size, fs::file_time_type& mtime) const {
+    if (config_index_.Covers(filename)) {
+        auto entry = config_index_.Find(fs::path(filename).filename().string());
+        if (!entry) return false;
+        size = entry->size;
+        mtime = entry->mtime;
+        return true;
+    }
+    std::error_code ec;
+    size = fs::file_size(filename, ec);
+    if (!ec) mtime = fs::last_write_time(filename, ec);
+    return !ec;
+}
+
+bool ConfigSystem::WatchedByIndex() const {
+    std::string base = active_delta_ ? active_delta_->base : std::string();
+    return config_index_.Covers(current_config_file_) && (base.empty() || config_index_.Covers(base));
+}
+
+void ConfigSystem::CheckHotReload() {
+    if (!hot_reload_ || current_config_file_.empty()) return;
+
+    auto now = std::chrono::steady_clock::now();
+    if (watched_file_ != current_config_file_) {
+        // switched files ourselves; start watching from the current state
+        watched_file_ = current_config_file_;
+        watched_stamp_ = CurrentWatchStamp();
+        watched_version_ = config_index_.GetVersion();
+        reload_poll_due_ = now + kReloadPoll;
+        reload_armed_ = false;
+        return;
+    }
+
+    std::uint64_t version = config_index_.GetVersion();
+    bool poll = !WatchedByIndex() && now >= reload_poll_due_;
+    if (version != watched_version_ || poll) {
+        watched_version_ = version;
+        if (poll) reload_poll_due_ = now + kReloadPoll;
+        WatchStamp stamp = CurrentWatchStamp();
+        if (!(stamp == watched_stamp_)) {
+            // every further write pushes the deadline out, so a burst becomes one reload
+            watched_stamp_ = stamp;
+            reload_armed_ = true;
+            reload_due_ = now + kReloadDebounce;
+        }
+    }
+
+    if (reload_armed_ && now >= reload_due_) {
+        reload_armed_ = false;
+        RequestLoad(current_config_file_, false);
+    }
+}
+
+void ConfigSystem::NewFrame() {
+    PollSaveResults();
+    PollLoadResults();
+    CheckHotReload();
 }
 
 void ConfigSystem::ApplyConfig() {
-    for (auto& [id, state] : components_) {
-        if (state.is_open) {
+    for (ComponentId id : dirty_list_) {
+        const ComponentState& state = components_[id];
+        if ((dirty_fields_[id] & Field_Window) && state.is_open) {
             ImGui::SetNextWindowPos(state.position, ImGuiCond_Always);
             ImGui::SetNextWindowSize(state.size, ImGuiCond_Always);
         }
+        dirty_fields_[id] = 0;
     }
+    dirty_list_.clear();
 }
 
 void ConfigSystem::RenderUI() {
     ImGui::Begin("Config System", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
 
     if (ImGui::Button("Refresh configs"))
-        config_files_ = GetConfigFiles();
+        config_index_.Refresh();
 
     ImGui::Text("Available configs:");
-    for (const auto& file : config_files_) {
-        if (ImGui::Selectable(file.c_str(), current_config_file_ == file)) {
-            LoadConfig(file);
+    auto entries = config_index_.GetEntries(); // in-memory index, no filesystem access here
+    for (const auto& entry : *entries) {
+        if (ImGui::Selectable(entry.name.c_str(), current_config_file_ == entry.name)) {
+            LoadConfigAsync(entry.name); // swapped in by NewFrame, no file I/O in this frame
+        } else if (ImGui::IsItemHovered()) {
+            PrefetchConfig(entry.name);
         }
     }
 
     if (ImGui::Button("Save current config")) {
-        std::string name = "config_" + std::to_string(time(nullptr)) + ".json";
-        SaveConfig(name);
+        std::string name = "config_" + std::to_string(time(nullptr));
+        std::string base = DeltaBase();
+        if (save_as_delta_ && !base.empty())
+            SaveDeltaAsync(name + ConfigDelta::kSuffix, base);
+        else
+            SaveConfigAsync(name + (save_binary_ ? ConfigBinaryFormat::kExtension : ".json"), save_binary_ ? ConfigFormat::Binary : ConfigFormat::Json);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Binary", &save_binary_);
+    ImGui::SameLine();
+    ImGui::Checkbox("Delta", &save_as_delta_);
+    ImGui::Checkbox("Hot reload", &hot_reload_);
+
+    if (layers_->HasBase()) {
+        ImGui::Separator();
+        ImGui::Text("Profile overlay:");
+        if (ImGui::Selectable("(none)", layers_->GetActiveOverlay().empty()))
+            SetActiveOverlay("");
+        for (const auto& name : layers_->GetOverlayNames()) {
+            if (ImGui::Selectable(name.c_str(), layers_->GetActiveOverlay() == name))
+                SetActiveOverlay(name);
+        }
     }
+    if (!save_status_.empty())
+        ImGui::TextDisabled("%s", save_status_.c_str());
 
     ImGui::End();
 }
@@ -118,15 +923,3 @@ ConfigSystem::ComponentState ConfigSystem::DeserializeComponent(const json& j) {
 
     return s;
 }
-
-std::vector<std::string> ConfigSystem::GetConfigFiles() {
-    std::vector<std::string> files;
-    try {
-        for (auto& p : fs::directory_iterator(".")) {
-            if (p.path().extension() == ".json") {
-                files.push_back(p.path().filename().string());
-            }
-        }
-    } catch (...) {}
-    return files;
-}
@@ -7,8 +7,23 @@
 #include <filesystem>
 #include <fstream>
 #include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <list>
+#include <cstdint>
+#include <chrono>
+#include "Configuration_Directory_Index.hpp"
 
 using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+class ConfigDelta;
+class ConfigLayerStack;
 
 class ConfigSystem {
 public:
@@ -23,26 +38,250 @@ public:
         ImVec4 color = {1.0f, 1.0f, 1.0f, 1.0f};
     };
 
-    ConfigSystem() = default;
-    ~ConfigSystem() = default;
+    using ComponentId = std::uint32_t;
+
+    // One bit per ComponentState field, used for change tracking.
+    enum ComponentField : std::uint32_t {
+        Field_IsOpen      = 1 << 0,
+        Field_Position    = 1 << 1,
+        Field_Size        = 1 << 2,
+        Field_SliderFloat = 1 << 3,
+        Field_SliderInt   = 1 << 4,
+        Field_Checkbox    = 1 << 5,
+        Field_Color       = 1 << 6,
+        Field_All         = (1 << 7) - 1,
+        Field_Window      = Field_IsOpen | Field_Position | Field_Size
+    };
+
+    // Changed fields of one component relative to some base state.
+    struct ComponentPatch {
+        std::string id;
+        std::uint32_t fields = 0;
+        ComponentState values;
+    };
+
+    enum class ConfigFormat {
+        Json,
+        Binary
+    };
+
+    ConfigSystem();
+    ~ConfigSystem();
 
     bool Initialize(ID3D11Device* device, ID3D11DeviceContext* context);
 
+    // Call at the start of every frame, before ApplyConfig. Installs finished background
+    // loads and saves and drives hot reload, so component state only changes here.
+    void NewFrame();
     void RenderUI();
 
-    bool SaveConfig(const std::string& filename);
+    bool SaveConfig(const std::string& filename, ConfigFormat format = ConfigFormat::Json);
+    // Detects JSON or binary from the file header.
     bool LoadConfig(const std::string& filename);
 
-    void AddComponent(const std::string& id);
+    // Reads and parses the config on the loader thread; the result is swapped in by the next
+    // NewFrame(). Served straight from the prefetch cache when a fresh copy is there.
+    void LoadConfigAsync(const std::string& filename);
+    // Queues a low priority background read into the prefetch cache (e.g. on hover).
+    void PrefetchConfig(const std::string& filename);
+
+    // Copy of every component, and the reverse: assigns components that came from
+    // somewhere other than a config file (e.g. the content store), dropping deltas and layers.
+    std::vector<ComponentState> GetComponents() const { return components_; }
+    void LoadComponents(const std::vector<ComponentState>& components);
+
+    // Writes to <filename>.<pid>.<n>.tmp and renames it over filename.
+    static bool WriteConfigFile(const std::string& filename, const std::string& data);
+
+    // Rewrites a config file of either format in the requested format.
+    static bool ConvertConfig(const std::string& input, const std::string& output, ConfigFormat format);
+
+    // Snapshots the components and writes them on the background saver thread, in order.
+    // A save queued while one of the same file is still pending replaces it.
+    void SaveConfigAsync(const std::string& filename, ConfigFormat format = ConfigFormat::Json);
+    bool IsSaving();
+
+    // Writes only the components and fields that differ from base_filename (see ConfigDelta).
+    bool SaveDelta(const std::string& filename, const std::string& base_filename);
+    void SaveDeltaAsync(const std::string& filename, const std::string& base_filename);
+    // Applies a delta file on top of the live components without reloading its base.
+    bool ApplyDelta(const std::string& filename);
+
+    // Layered profiles (see ConfigLayerStack): a full base config, named overlays of which one
+    // is active, and a user layer on top. Loading a plain config drops the layers.
+    bool LoadBaseLayer(const std::string& filename);
+    // Accepts a delta of the base layer's file or a full config; a full config is stored as its
+    // differences from the base.
+    bool LoadOverlay(const std::string& name, const std::string& filename);
+    // Empty name for no overlay. Only components named by the old or new overlay are recomputed.
+    bool SetActiveOverlay(const std::string& name);
+    void SetUserOverride(const ComponentPatch& patch);
+    // Writes the user layer as a delta against the base layer.
+    bool SaveUserLayer(const std::string& filename);
+
+    // Reloads the active config (and a delta's base) in the background when it changes on disk.
+    void SetHotReload(bool enabled) { hot_reload_ = enabled; }
+    bool IsHotReloadEnabled() const { return hot_reload_; }
+
+    // Ids are stable for the lifetime of the ConfigSystem; hold on to those. The references
+    // GetComponent returns are read-only and only valid until the next component is added.
+    ComponentId AddComponent(const std::string& id);
+    std::optional<ComponentId> FindComponent(const std::string& id) const;
+    const ComponentState* GetComponent(const std::string& id) const;
+    const ComponentState& GetComponent(ComponentId id) const { return components_[id]; }
+    // The only way to change a component from outside: copies every field but the id and marks
+    // what changed dirty, so ApplyConfig and delta saves see it. With a base layer loaded the
+    // changed fields go into the user layer, so switching overlays keeps them.
+    void SetComponent(ComponentId id, const ComponentState& state);
+
+    // Pushes window placement only for components whose window fields changed since the last apply.
     void ApplyConfig();
 
+    static std::uint32_t DiffComponent(const ComponentState& a, const ComponentState& b);
+
 private:
-    json SerializeComponent(const ComponentState& state);
-    ComponentState DeserializeComponent(const json& j);
-    std::vector<std::string> GetConfigFiles();
+    friend class ConfigDelta;
+
+    struct SaveRequest {
+        std::string filename;
+        ConfigFormat format = ConfigFormat::Json;
+        std::string delta_base;
+        std::shared_ptr<const std::vector<ComponentState>> components;
+    };
+
+    struct SaveResult {
+        std::string filename;
+        bool ok = false;
+        std::string delta_base;
+        std::vector<ComponentState> delta_originals;
+    };
+
+    // A fully resolved config read off the UI thread.
+    struct LoadedConfig {
+        std::string filename;
+        bool ok = false;
+        std::string error;
+        std::vector<ComponentState> components;
+        std::string delta_base;
+        std::vector<ComponentState> delta_originals;
+    };
+
+    // Size and mtime of the watched files, from the directory index or a stat.
+    struct WatchStamp {
+        std::uintmax_t size[2] = {};
+        fs::file_time_type mtime[2] = {};
+        bool operator==(const WatchStamp& other) const;
+    };
+
+    // A parsed config kept until the file (or its delta base) changes on disk.
+    struct CachedConfig {
+        std::string filename;
+        WatchStamp stamp;
+        std::shared_ptr<const LoadedConfig> config;
+    };
+
+    // Base values of the components the loaded delta overrides, so switching to another
+    // delta of the same base only touches the components either of them names.
+    struct ActiveDelta {
+        std::string base;
+        std::unordered_map<ComponentId, ComponentState> base_states;
+    };
+
+    void SaveWorker();
+    void PollSaveResults();
+    void QueueSave(SaveRequest&& request);
+    // UI thread. A fresh copy while the saver is busy (it may still read the last one),
+    // otherwise the last snapshot patched with what changed since.
+    std::shared_ptr<const std::vector<ComponentState>> SnapshotComponents(bool saver_busy);
+    static bool EncodeComponents(const std::vector<ComponentState>& components, ConfigFormat format, std::string& out, std::string* error);
+    static bool ReadComponents(const std::string& filename, const std::function<void(ComponentState&&)>& sink, std::string* error);
+    static bool BuildDelta(const std::string& base_filename, const std::vector<ComponentState>& components,
+                           std::string& data, std::vector<ComponentState>& originals, std::string* error);
+
+    // Also stamps the files for the prefetch cache, empty if they changed while being read.
+    bool ReadConfig(const std::string& filename, LoadedConfig& out, std::optional<WatchStamp>* stamp = nullptr) const;
+    // A hot reload of the base layer's file swaps the base under the overlays and user layer;
+    // anything else replaces the layers.
+    void InstallConfig(const LoadedConfig& config, bool reload);
+    // A user request supersedes every earlier load; a hot reload yields to any user request
+    // that hasn't installed yet.
+    void RequestLoad(const std::string& filename, bool user_request);
+    void LoadWorker();
+    void PollLoadResults();
+    void CheckHotReload();
+    WatchStamp CurrentWatchStamp() const;
+    // Stamp of a file and an optional delta base, empty if the file doesn't exist.
+    std::optional<WatchStamp> StampFiles(const std::string& filename, const std::string& base) const;
+    // From the directory index for the files it lists, a stat for anything outside it.
+    bool StampFile(const std::string& filename, std::uintmax_t& size, fs::file_time_type& mtime) const;
+    // Files outside the index don't bump its version and are polled instead.
+    bool WatchedByIndex() const;
+    // load_mutex_ must be held.
+    std::shared_ptr<const LoadedConfig> FindCached(const std::string& filename);
+
+    void ApplyLayerChanges(const std::vector<std::string>& ids);
+
+    bool LoadDelta(const std::string& filename, std::string* error);
+    bool SwitchDelta(const ConfigDelta& delta, std::string* error);
+    void SetActiveDelta(const std::string& base, std::vector<ComponentState>&& originals);
+    std::string DeltaBase() const;
 
-    std::unordered_map<std::string, ComponentState> components_;
+    static json SerializeComponent(const ComponentState& state);
+    static ComponentState DeserializeComponent(const json& j);
+
+    ComponentId InternComponent(const std::string& id);
+    // Copies only the differing fields and marks the component dirty, returns the changed mask.
+    std::uint32_t AssignComponent(ComponentId id, const ComponentState& state);
+
+    // Components live densely, indexed by their interned id.
+    std::vector<ComponentState> components_;
+    std::vector<std::uint32_t> dirty_fields_;
+    std::vector<ComponentId> dirty_list_;
+    std::unordered_map<std::string, ComponentId> component_ids_;
     std::string current_config_file_;
-    std::vector<std::string> config_files_;
+    std::optional<ActiveDelta> active_delta_;
+    std::unique_ptr<ConfigLayerStack> layers_;
+    ConfigDirectoryIndex config_index_{"."};
     bool is_initialized_ = false;
+
+    std::thread save_thread_;
+    std::mutex save_mutex_;
+    std::condition_variable save_cv_;
+    std::deque<SaveRequest> pending_saves_;
+    // Copy of components_ for the saver, refreshed from the ids changed since it was taken.
+    std::shared_ptr<std::vector<ComponentState>> snapshot_;
+    std::vector<ComponentId> snapshot_stale_;
+    std::vector<bool> snapshot_stale_flags_;
+    std::optional<SaveResult> finished_save_;
+    bool save_in_flight_ = false;
+    bool stop_saver_ = false;
+    std::string save_status_;
+    bool save_binary_ = false;
+    bool save_as_delta_ = true;
+
+    std::thread load_thread_;
+    std::mutex load_mutex_;
+    std::condition_variable load_cv_;
+    std::optional<std::string> pending_load_;
+    std::deque<std::string> prefetch_queue_;
+    std::list<CachedConfig> prefetch_cache_; // most recently used first
+    std::shared_ptr<const LoadedConfig> finished_load_;
+    // Bumped by every user load; loads carry the generation they were requested in, and only
+    // results of the latest one install. Hot reloads reuse it rather than starting a new one.
+    std::uint64_t load_generation_ = 0;
+    std::uint64_t pending_generation_ = 0;
+    std::uint64_t finished_generation_ = 0;
+    std::uint64_t installed_generation_ = 0; // UI thread: newest generation polled
+    bool stop_loader_ = false;
+    static constexpr size_t kPrefetchCacheSize = 8;
+
+    bool hot_reload_ = false;
+    std::string watched_file_;
+    WatchStamp watched_stamp_;
+    std::uint64_t watched_version_ = 0;
+    bool reload_armed_ = false;
+    std::chrono::steady_clock::time_point reload_due_;
+    std::chrono::steady_clock::time_point reload_poll_due_;
+    static constexpr std::chrono::milliseconds kReloadDebounce{150};
+    static constexpr std::chrono::milliseconds kReloadPoll{500};
 };
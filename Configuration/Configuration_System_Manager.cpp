@@ -11,7 +11,7 @@ bool ConfigurationSystemManager::Initialize() {
         } else {
             std::cout << "[ConfigManager] Directory already exists: " << config_dir_ << std::endl;
         }
-        return true;
+        return store_.Initialize();
     } catch (const std::exception& e) {
         std::cerr << "[ConfigManager] Failed to initialize: " << e.what() << std::endl;
         return false;
@@ -33,3 +33,30 @@ void ConfigurationSystemManager::CreateDefaultConfigs() {
         std::cerr << "[ConfigManager] Failed to create default configs." << std::endl;
     }
 }
+
+bool ConfigurationSystemManager::SaveToStore(const std::string& name, const ConfigSystem& config) {
+    size_t written = 0;
+    if (!store_.Save(name, config.GetComponents(), &written)) {
+        std::cerr << "[ConfigManager] Failed to store config: " << name << std::endl;
+        return false;
+    }
+    std::cout << "[ConfigManager] Stored config " << name << " (" << written << " new blobs)" << std::endl;
+    return true;
+}
+
+bool ConfigurationSystemManager::LoadFromStore(const std::string& name, ConfigSystem& config) {
+    std::vector<ConfigSystem::ComponentState> components;
+    if (!store_.Load(name, components)) return false;
+    config.LoadComponents(components);
+    return true;
+}
+
+std::vector<std::string> ConfigurationSystemManager::ListStoredConfigs() const {
+    return store_.ListManifests();
+}
+
+size_t ConfigurationSystemManager::CollectGarbage() {
+    size_t removed = store_.CollectGarbage();
+    std::cout << "[ConfigManager] Removed " << removed << " unreferenced blobs" << std::endl;
+    return removed;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Configuration_System.hpp"  // include your existing system
+#include "Configuration_Content_Store.hpp"
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -14,7 +15,15 @@ public:
     // Create "Configurations" directory and default files if missing
     bool Initialize();
 
+    // Saves/loads through the deduplicated store under Configurations/ (see ConfigContentStore).
+    bool SaveToStore(const std::string& name, const ConfigSystem& config);
+    bool LoadFromStore(const std::string& name, ConfigSystem& config);
+    std::vector<std::string> ListStoredConfigs() const;
+    // Deletes blobs no stored config references.
+    size_t CollectGarbage();
+
 private:
     void CreateDefaultConfigs();
     const std::string config_dir_ = "Configurations";
+    ConfigContentStore store_{config_dir_};
 };
@@ -0,0 +1,702 @@
+// Async_IO.cpp
+#include "Async_IO.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+struct AsyncIO::Pending {
+    Op op;
+    Callback callback;
+    std::string pathStorage; // native strings the kernel reads while the op is in flight
+    std::string newPathStorage;
+};
+
+class AsyncIO::Backend {
+public:
+    virtual ~Backend() = default;
+    virtual void submit(std::vector<std::unique_ptr<Pending>>& batch) = 0;
+    virtual size_t inFlight() const = 0;
+    virtual bool isIoUring() const = 0;
+};
+
+namespace {
+
+using Op = AsyncIO::Op;
+using OpType = AsyncIO::OpType;
+using Pending = AsyncIO::Pending;
+using Result = AsyncIO::Result;
+
+#if defined(_WIN32) || defined(_WIN64)
+int errorFrom(const std::error_code& ec) {
+    int value = ec.default_error_condition().value();
+    return value > 0 ? value : EIO;
+}
+#endif
+
+// Runs one op with plain blocking calls, used by the thread pool backend.
+Result runBlocking(const Op& op) {
+    std::int64_t value = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    switch (op.type) {
+        case OpType::Open:
+            value = _wopen(op.path.c_str(), op.flags | O_BINARY, op.mode);
+            break;
+        case OpType::Read:
+            value = _lseeki64(op.fd, op.offset, SEEK_SET) < 0 ? -1 : _read(op.fd, op.buffer, static_cast<unsigned>(op.length));
+            break;
+        case OpType::Write:
+            value = _lseeki64(op.fd, op.offset, SEEK_SET) < 0 ? -1 : _write(op.fd, op.buffer, static_cast<unsigned>(op.length));
+            break;
+        case OpType::Fsync:
+            value = _commit(op.fd);
+            break;
+        case OpType::Close:
+            value = _close(op.fd);
+            break;
+        case OpType::Rename: {
+            std::error_code ec;
+            fs::rename(op.path, op.newPath, ec);
+            return Result{ec ? -errorFrom(ec) : 0};
+        }
+    }
+#else
+    switch (op.type) {
+        case OpType::Open:
+            value = ::open(op.path.c_str(), op.flags | O_CLOEXEC, op.mode);
+            break;
+        case OpType::Read:
+            value = ::pread(op.fd, op.buffer, op.length, op.offset);
+            break;
+        case OpType::Write:
+            value = ::pwrite(op.fd, op.buffer, op.length, op.offset);
+            break;
+        case OpType::Fsync:
+            value = ::fsync(op.fd);
+            break;
+        case OpType::Close:
+            value = ::close(op.fd);
+            break;
+        case OpType::Rename:
+            value = ::rename(op.path.c_str(), op.newPath.c_str());
+            break;
+    }
+#endif
+    return Result{value < 0 ? -static_cast<std::int64_t>(errno) : value};
+}
+
+class ThreadPoolBackend : public AsyncIO::Backend {
+public:
+    explicit ThreadPoolBackend(size_t threads) {
+        for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) {
+            workers_.emplace_back(&ThreadPoolBackend::workerLoop, this);
+        }
+    }
+
+    ~ThreadPoolBackend() override {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idleCv_.wait(lock, [this]() { return inFlight_ == 0; });
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) worker.join();
+    }
+
+    void submit(std::vector<std::unique_ptr<Pending>>& batch) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& pending : batch) queue_.push_back(std::move(pending));
+            inFlight_ += batch.size();
+        }
+        cv_.notify_all();
+    }
+
+    size_t inFlight() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inFlight_;
+    }
+
+    bool isIoUring() const override { return false; }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::unique_ptr<Pending> pending;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                pending = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            Result result = runBlocking(pending->op);
+            if (pending->callback) pending->callback(result);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--inFlight_ == 0) idleCv_.notify_all();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idleCv_;
+    std::deque<std::unique_ptr<Pending>> queue_;
+    std::vector<std::thread> workers_;
+    size_t inFlight_ = 0;
+    bool stopping_ = false;
+};
+
+#if defined(__linux__)
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int uringRegister(int fd, unsigned opcode, void* arg, unsigned args) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, args));
+}
+
+// Raw io_uring without liburing: the rings are mapped by hand. Submission is serialized by
+// mutex_; only the completion thread consumes the CQ. Ops beyond the CQ size wait in overflow_.
+class UringBackend : public AsyncIO::Backend {
+public:
+    static std::unique_ptr<UringBackend> create(unsigned queueDepth) {
+        std::unique_ptr<UringBackend> backend(new UringBackend());
+        if (!backend->init(queueDepth)) return nullptr;
+        backend->reaper_ = std::thread(&UringBackend::reaperLoop, backend.get());
+        return backend;
+    }
+
+    ~UringBackend() override {
+        if (reaper_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                // user_data 0 only wakes the completion thread
+                if (io_uring_sqe* sqe = nextSqe()) {
+                    sqe->opcode = IORING_OP_NOP;
+                    sqe->user_data = 0;
+                    commitSqe();
+                }
+                flushLocked();
+            }
+            reaper_.join();
+        }
+        if (sqes_) ::munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_) ::munmap(sqRing_, sqRingSize_);
+        if (ringFd_ >= 0) ::close(ringFd_);
+    }
+
+    void submit(std::vector<std::unique_ptr<Pending>>& batch) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& pending : batch) {
+            if (!overflow_.empty() || !queueLocked(pending)) overflow_.push_back(std::move(pending));
+        }
+        // Follow-ups from callbacks are flushed once the completion thread finishes its batch.
+        if (reaperThread_ != std::this_thread::get_id()) flushLocked();
+    }
+
+    size_t inFlight() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inFlight_ + overflow_.size();
+    }
+
+    bool isIoUring() const override { return true; }
+
+private:
+    UringBackend() = default;
+
+    bool init(unsigned queueDepth) {
+        io_uring_params params{};
+        ringFd_ = uringSetup(queueDepth, &params);
+        if (ringFd_ < 0) return false;
+
+        // Openat needs 5.6 and renameat 5.11; older kernels use the thread pool for everything.
+        std::vector<unsigned char> probeBuffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(probeBuffer.data());
+        if (uringRegister(ringFd_, IORING_REGISTER_PROBE, probe, 256) < 0) return false;
+        for (unsigned op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC,
+                            IORING_OP_RENAMEAT, IORING_OP_CLOSE, IORING_OP_NOP}) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+        }
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+        if (sqRing_ == MAP_FAILED) { sqRing_ = nullptr; return false; }
+        if (singleMmap) {
+            cqRing_ = sqRing_;
+        } else {
+            cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+            if (cqRing_ == MAP_FAILED) { cqRing_ = nullptr; return false; }
+        }
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries_ = params.sq_entries;
+
+        auto* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        // One CQ slot stays free for the shutdown wake-up.
+        maxInFlight_ = params.cq_entries - 1;
+        return true;
+    }
+
+    // mutex_ must be held for the SQ helpers below.
+    io_uring_sqe* nextSqe() {
+        unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if (*sqTail_ - head >= sqEntries_) return nullptr;
+        io_uring_sqe* sqe = &sqes_[*sqTail_ & sqMask_];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    void commitSqe() {
+        unsigned tail = *sqTail_;
+        sqArray_[tail & sqMask_] = tail & sqMask_;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    bool queueLocked(std::unique_ptr<Pending>& pending) {
+        if (inFlight_ >= maxInFlight_) return false;
+        io_uring_sqe* sqe = nextSqe();
+        if (!sqe) {
+            flushLocked();
+            sqe = nextSqe();
+            if (!sqe) return false;
+        }
+
+        const Op& op = pending->op;
+        switch (op.type) {
+            case OpType::Open:
+                sqe->opcode = IORING_OP_OPENAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<std::uint64_t>(pending->pathStorage.c_str());
+                sqe->len = static_cast<unsigned>(op.mode);
+                sqe->open_flags = static_cast<unsigned>(op.flags | O_CLOEXEC);
+                break;
+            case OpType::Read:
+            case OpType::Write:
+                sqe->opcode = op.type == OpType::Read ? IORING_OP_READ : IORING_OP_WRITE;
+                sqe->fd = op.fd;
+                sqe->addr = reinterpret_cast<std::uint64_t>(op.buffer);
+                sqe->len = static_cast<unsigned>(std::min<size_t>(op.length, 1u << 30));
+                sqe->off = static_cast<std::uint64_t>(op.offset);
+                break;
+            case OpType::Fsync:
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fd = op.fd;
+                break;
+            case OpType::Rename:
+                sqe->opcode = IORING_OP_RENAMEAT;
+                sqe->fd = AT_FDCWD;
+                sqe->addr = reinterpret_cast<std::uint64_t>(pending->pathStorage.c_str());
+                sqe->len = static_cast<unsigned>(AT_FDCWD);
+                sqe->addr2 = reinterpret_cast<std::uint64_t>(pending->newPathStorage.c_str());
+                break;
+            case OpType::Close:
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = op.fd;
+                break;
+        }
+        sqe->user_data = reinterpret_cast<std::uint64_t>(pending.release());
+        commitSqe();
+        ++inFlight_;
+        return true;
+    }
+
+    // Hands every queued SQE to the kernel in one call.
+    void flushLocked() {
+        while (true) {
+            unsigned toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            if (toSubmit == 0) return;
+            int submitted = uringEnter(ringFd_, toSubmit, 0, 0);
+            if (submitted < 0) {
+                if (errno == EINTR) continue;
+                return; // EAGAIN/EBUSY: the SQEs stay queued and go out with the next flush
+            }
+        }
+    }
+
+    void reaperLoop() {
+        reaperThread_ = std::this_thread::get_id();
+        std::vector<std::pair<std::uint64_t, std::int32_t>> completions;
+
+        while (true) {
+            int rc = uringEnter(ringFd_, 0, 1, IORING_ENTER_GETEVENTS);
+            if (rc < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) break;
+
+            completions.clear();
+            unsigned head = *cqHead_;
+            unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                completions.emplace_back(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+
+            for (const auto& [userData, res] : completions) {
+                if (userData == 0) continue;
+                std::unique_ptr<Pending> pending(reinterpret_cast<Pending*>(userData));
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --inFlight_;
+                }
+                if (pending->callback) pending->callback(Result{res});
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            while (!overflow_.empty() && queueLocked(overflow_.front())) overflow_.pop_front();
+            flushLocked();
+            if (stopping_ && inFlight_ == 0 && overflow_.empty()) break;
+        }
+    }
+
+    int ringFd_ = -1;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    size_t sqesSize_ = 0;
+
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqEntries_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Pending>> overflow_;
+    size_t inFlight_ = 0;
+    size_t maxInFlight_ = 0;
+    bool stopping_ = false;
+    std::thread reaper_;
+    std::atomic<std::thread::id> reaperThread_{};
+};
+
+#endif // __linux__
+
+// open, write until done, optional fsync, close, rename; any failure closes and drops the temp file.
+struct WriteChain : std::enable_shared_from_this<WriteChain> {
+    enum class Stage { Open, Write, Sync, Close, Rename };
+
+    AsyncIO* io = nullptr;
+    fs::path path;
+    fs::path tempPath;
+    std::string content;
+    bool durable = false;
+    AsyncIO::Callback done;
+
+    Stage stage = Stage::Open;
+    int fd = -1;
+    size_t written = 0;
+    std::int64_t error = 0;
+
+    void start() {
+        submit(Op::open(tempPath, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY));
+    }
+
+    void submit(Op op) {
+        auto self = shared_from_this();
+        io->submit(std::move(op), [self](Result result) { self->next(result); });
+    }
+
+    void writeRest() {
+        stage = Stage::Write;
+        submit(Op::write(fd, content.data() + written, content.size() - written, static_cast<std::int64_t>(written)));
+    }
+
+    void closeFile() {
+        stage = Stage::Close;
+        submit(Op::close(fd));
+    }
+
+    void next(Result result) {
+        switch (stage) {
+            case Stage::Open:
+                if (!result.ok()) return finish(result);
+                fd = static_cast<int>(result.value);
+                if (content.empty()) return durable ? sync() : closeFile();
+                return writeRest();
+            case Stage::Write:
+                if (!result.ok() || result.value == 0) {
+                    error = result.ok() ? -EIO : result.value;
+                    return closeFile();
+                }
+                written += static_cast<size_t>(result.value);
+                if (written < content.size()) return writeRest();
+                return durable ? sync() : closeFile();
+            case Stage::Sync:
+                if (!result.ok()) error = result.value;
+                return closeFile();
+            case Stage::Close:
+                if (!result.ok() && error == 0) error = result.value;
+                if (error != 0) {
+                    std::error_code ec;
+                    fs::remove(tempPath, ec);
+                    return finish(Result{error});
+                }
+                stage = Stage::Rename;
+                return submit(Op::rename(tempPath, path));
+            case Stage::Rename:
+                return finish(result.ok() ? Result{static_cast<std::int64_t>(written)} : result);
+        }
+    }
+
+    void sync() {
+        stage = Stage::Sync;
+        submit(Op::fsync(fd));
+    }
+
+    void finish(Result result) {
+        if (done) done(result);
+    }
+};
+
+// open, read in growing chunks until EOF, close.
+struct ReadChain : std::enable_shared_from_this<ReadChain> {
+    enum class Stage { Open, Read, Close };
+
+    AsyncIO* io = nullptr;
+    fs::path path;
+    std::function<void(std::optional<std::string>)> done;
+
+    Stage stage = Stage::Open;
+    int fd = -1;
+    std::string data;
+    size_t used = 0;
+    size_t chunk = 16 * 1024;
+    bool failed = false;
+
+    void start() {
+        submit(Op::open(path, O_RDONLY | O_BINARY));
+    }
+
+    void submit(Op op) {
+        auto self = shared_from_this();
+        io->submit(std::move(op), [self](Result result) { self->next(result); });
+    }
+
+    void readMore() {
+        stage = Stage::Read;
+        data.resize(used + chunk);
+        submit(Op::read(fd, data.data() + used, chunk, static_cast<std::int64_t>(used)));
+    }
+
+    void next(Result result) {
+        switch (stage) {
+            case Stage::Open:
+                if (!result.ok()) return done(std::nullopt);
+                fd = static_cast<int>(result.value);
+                return readMore();
+            case Stage::Read:
+                if (result.ok() && result.value > 0) {
+                    used += static_cast<size_t>(result.value);
+                    chunk = std::min<size_t>(chunk * 2, 1024 * 1024);
+                    return readMore();
+                }
+                failed = !result.ok();
+                data.resize(used);
+                stage = Stage::Close;
+                return submit(Op::close(fd));
+            case Stage::Close:
+                if (failed) return done(std::nullopt);
+                return done(std::move(data));
+        }
+    }
+};
+
+std::unique_ptr<Pending> makePending(Op op, AsyncIO::Callback callback) {
+    auto pending = std::make_unique<Pending>();
+    pending->pathStorage = op.path.string();
+    pending->newPathStorage = op.newPath.string();
+    pending->op = std::move(op);
+    pending->callback = std::move(callback);
+    return pending;
+}
+
+} // namespace
+
+AsyncIO::Op AsyncIO::Op::open(const fs::path& path, int flags, int mode) {
+    Op op;
+    op.type = OpType::Open;
+    op.path = path;
+    op.flags = flags;
+    op.mode = mode;
+    return op;
+}
+
+AsyncIO::Op AsyncIO::Op::read(int fd, void* buffer, size_t length, std::int64_t offset) {
+    Op op;
+    op.type = OpType::Read;
+    op.fd = fd;
+    op.buffer = buffer;
+    op.length = length;
+    op.offset = offset;
+    return op;
+}
+
+AsyncIO::Op AsyncIO::Op::write(int fd, const void* buffer, size_t length, std::int64_t offset) {
+    Op op = read(fd, const_cast<void*>(buffer), length, offset);
+    op.type = OpType::Write;
+    return op;
+}
+
+AsyncIO::Op AsyncIO::Op::fsync(int fd) {
+    Op op;
+    op.type = OpType::Fsync;
+    op.fd = fd;
+    return op;
+}
+
+AsyncIO::Op AsyncIO::Op::rename(const fs::path& from, const fs::path& to) {
+    Op op;
+    op.type = OpType::Rename;
+    op.path = from;
+    op.newPath = to;
+    return op;
+}
+
+AsyncIO::Op AsyncIO::Op::close(int fd) {
+    Op op;
+    op.type = OpType::Close;
+    op.fd = fd;
+    return op;
+}
+
+std::string AsyncIO::Result::error() const {
+    return ok() ? std::string() : std::generic_category().message(static_cast<int>(-value));
+}
+
+AsyncIO::AsyncIO(unsigned queueDepth, size_t fallbackThreads) {
+#if defined(__linux__)
+    backend_ = UringBackend::create(queueDepth);
+#else
+    (void)queueDepth;
+#endif
+    if (!backend_) backend_ = std::make_unique<ThreadPoolBackend>(fallbackThreads);
+}
+
+AsyncIO::~AsyncIO() = default;
+
+bool AsyncIO::usesIoUring() const {
+    return backend_->isIoUring();
+}
+
+size_t AsyncIO::inFlight() const {
+    return backend_->inFlight();
+}
+
+void AsyncIO::submit(Op op, Callback callback) {
+    std::vector<std::unique_ptr<Pending>> batch;
+    batch.push_back(makePending(std::move(op), std::move(callback)));
+    backend_->submit(batch);
+}
+
+std::future<AsyncIO::Result> AsyncIO::submit(Op op) {
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
+    submit(std::move(op), [promise](Result result) { promise->set_value(result); });
+    return future;
+}
+
+void AsyncIO::submitBatch(std::vector<std::pair<Op, Callback>> ops) {
+    std::vector<std::unique_ptr<Pending>> batch;
+    batch.reserve(ops.size());
+    for (auto& [op, callback] : ops) batch.push_back(makePending(std::move(op), std::move(callback)));
+    backend_->submit(batch);
+}
+
+void AsyncIO::writeFile(const fs::path& path, std::string content, bool durable, Callback callback, const fs::path& tempDir) {
+    auto chain = std::make_shared<WriteChain>();
+    chain->io = this;
+    chain->path = path;
+    // Unique per request: concurrent writes of one file must not share (and truncate) a temp file.
+    static std::atomic<std::uint64_t> tempCounter{0};
+#if defined(_WIN32) || defined(_WIN64)
+    long pid = _getpid();
+#else
+    long pid = static_cast<long>(getpid());
+#endif
+    fs::path tempName = path.filename();
+    tempName += "." + std::to_string(pid) + "." + std::to_string(tempCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    chain->tempPath = (tempDir.empty() ? path.parent_path() : tempDir) / tempName;
+    chain->content = std::move(content);
+    chain->durable = durable;
+    chain->done = std::move(callback);
+    chain->start();
+}
+
+std::future<AsyncIO::Result> AsyncIO::writeFile(const fs::path& path, std::string content, bool durable, const fs::path& tempDir) {
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
+    writeFile(path, std::move(content), durable, [promise](Result result) { promise->set_value(result); }, tempDir);
+    return future;
+}
+
+void AsyncIO::readFile(const fs::path& path, std::function<void(std::optional<std::string>)> callback) {
+    auto chain = std::make_shared<ReadChain>();
+    chain->io = this;
+    chain->path = path;
+    chain->done = std::move(callback);
+    chain->start();
+}
+
+std::future<std::optional<std::string>> AsyncIO::readFile(const fs::path& path) {
+    auto promise = std::make_shared<std::promise<std::optional<std::string>>>();
+    auto future = promise->get_future();
+    readFile(path, [promise](std::optional<std::string> data) { promise->set_value(std::move(data)); });
+    return future;
+}
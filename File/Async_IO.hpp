@@ -0,0 +1,86 @@
+#ifndef ASYNC_IO_HPP
+#define ASYNC_IO_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Asynchronous file operations. On Linux the ops go through an io_uring driven by one
+// completion thread, so hundreds can be in flight without a thread each; where io_uring
+// (or one of the ops it needs) is missing they run on a small blocking thread pool instead.
+// Callbacks run on the completion thread and may submit follow-up ops.
+class AsyncIO {
+public:
+    enum class OpType { Open, Read, Write, Fsync, Rename, Close };
+
+    // Paths are copied into the op; read and write buffers must outlive it.
+    struct Op {
+        OpType type = OpType::Open;
+        fs::path path;
+        fs::path newPath;
+        int fd = -1;
+        int flags = 0;
+        int mode = 0;
+        void* buffer = nullptr;
+        size_t length = 0;
+        std::int64_t offset = 0;
+
+        static Op open(const fs::path& path, int flags, int mode = 0644);
+        static Op read(int fd, void* buffer, size_t length, std::int64_t offset);
+        static Op write(int fd, const void* buffer, size_t length, std::int64_t offset);
+        static Op fsync(int fd);
+        static Op rename(const fs::path& from, const fs::path& to);
+        static Op close(int fd);
+    };
+
+    // Syscall style: the fd or byte count on success, -errno on failure.
+    struct Result {
+        std::int64_t value = 0;
+        bool ok() const { return value >= 0; }
+        std::string error() const;
+    };
+
+    using Callback = std::function<void(Result)>;
+
+    explicit AsyncIO(unsigned queueDepth = 256, size_t fallbackThreads = 4);
+    // Waits for every outstanding op, including follow-ups submitted by callbacks.
+    ~AsyncIO();
+
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    bool usesIoUring() const;
+    size_t inFlight() const;
+
+    void submit(Op op, Callback callback);
+    std::future<Result> submit(Op op);
+    // Queues every op and enters the kernel once.
+    void submitBatch(std::vector<std::pair<Op, Callback>> ops);
+
+    // Writes <path>.<pid>.<n>.tmp, optionally fsyncs it, and renames it over path. Yields the byte count.
+    // Concurrent writes of one path don't share a temp file; the last rename wins. A tempDir puts
+    // the temp file there instead of next to path; it must be on the same volume for the rename.
+    void writeFile(const fs::path& path, std::string content, bool durable, Callback callback, const fs::path& tempDir = {});
+    std::future<Result> writeFile(const fs::path& path, std::string content, bool durable = false, const fs::path& tempDir = {});
+
+    // Reads a whole file, nullopt if it can't be opened or read.
+    void readFile(const fs::path& path, std::function<void(std::optional<std::string>)> callback);
+    std::future<std::optional<std::string>> readFile(const fs::path& path);
+
+    // Implementation details, defined in Async_IO.cpp.
+    struct Pending;
+    class Backend;
+
+private:
+    std::unique_ptr<Backend> backend_;
+};
+
+#endif // ASYNC_IO_HPP
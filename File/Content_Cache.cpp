@@ -0,0 +1,128 @@
+// Content_Cache.cpp
+#include "Content_Cache.hpp"
+
+ContentCache::ContentCache(size_t capacityBytes, size_t mapThreshold)
+    : capacityBytes_(capacityBytes), mapThreshold_(mapThreshold) {
+}
+
+std::string ContentCache::makeKey(const fs::path& path) {
+    return path.lexically_normal().generic_string();
+}
+
+std::string ContentCache::View::text() const {
+#if defined(_WIN32) || defined(_WIN64)
+    std::string out;
+    out.reserve(data_.size());
+    size_t start = 0;
+    for (size_t cr; (cr = data_.find("\r\n", start)) != std::string_view::npos; start = cr + 1) {
+        out.append(data_.substr(start, cr - start));
+    }
+    out.append(data_.substr(start));
+    return out;
+#else
+    return str();
+#endif
+}
+
+ContentCache::View ContentCache::read(const fs::path& path, bool mapLarge) {
+    View view;
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(path, ec);
+    fs::file_time_type mtime = ec ? fs::file_time_type{} : fs::last_write_time(path, ec);
+    std::string key = makeKey(path);
+
+    if (ec) {
+        invalidate(path);
+        return view;
+    }
+
+    if (size <= mapThreshold_) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            if (it->second->size == size && it->second->mtime == mtime) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                ++hits_;
+                view.text_ = it->second->text;
+                view.data_ = *view.text_;
+                return view;
+            }
+            eraseEntry(it->second);
+        }
+        ++misses_;
+    }
+
+    if (size > mapThreshold_ && mapLarge) {
+        // Large files are never cached: the view owns the mapping and releases it when dropped.
+        auto mapping = std::make_shared<MappedFile>(path);
+        if (!mapping->isOpen()) return view;
+        view.data_ = mapping->view();
+        view.mapping_ = std::move(mapping);
+        return view;
+    }
+
+    // Small files are copied into the cache anyway, so a plain read costs no more than a
+    // mapping and can't fault if the file is truncated halfway.
+    auto buffer = std::make_shared<std::string>();
+    if (!readWholeFile(path, *buffer)) return view;
+    std::shared_ptr<const std::string> text = std::move(buffer);
+    view.text_ = text;
+    view.data_ = *text;
+    if (size > mapThreshold_ || text->size() > mapThreshold_) return view;
+
+    // Keyed by the stat taken before reading, so a write racing this read forces a reload next time.
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) eraseEntry(it->second);
+    if (text->size() <= capacityBytes_) {
+        lru_.push_front(Entry{key, size, mtime, text});
+        entries_.emplace(std::move(key), lru_.begin());
+        bytes_ += text->size();
+        evict();
+    }
+    return view;
+}
+
+void ContentCache::invalidate(const fs::path& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(makeKey(path));
+    if (it != entries_.end()) eraseEntry(it->second);
+}
+
+void ContentCache::invalidateTree(const fs::path& directory) {
+    std::string prefix = makeKey(directory);
+    if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        auto next = std::next(it);
+        if (it->key.compare(0, prefix.size(), prefix) == 0) eraseEntry(it);
+        it = next;
+    }
+}
+
+void ContentCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    entries_.clear();
+    bytes_ = 0;
+}
+
+ContentCache::Stats ContentCache::getStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return Stats{hits_, misses_, entries_.size(), bytes_};
+}
+
+// mutex_ must be held.
+void ContentCache::eraseEntry(std::list<Entry>::iterator it) {
+    bytes_ -= it->text->size();
+    entries_.erase(it->key);
+    lru_.erase(it);
+}
+
+// mutex_ must be held.
+void ContentCache::evict() {
+    while (bytes_ > capacityBytes_ && !lru_.empty()) {
+        eraseEntry(std::prev(lru_.end()));
+    }
+}
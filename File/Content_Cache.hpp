@@ -0,0 +1,87 @@
+#ifndef CONTENT_CACHE_HPP
+#define CONTENT_CACHE_HPP
+
+#include "Mapped_File.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+// Read-through cache of file contents. Files up to mapThreshold are read once into memory and
+// kept in an LRU bounded by total bytes; larger files are handed out as a fresh read-only mapping,
+// or read uncached when the caller can't rule out a writer truncating them in place.
+// Every read stats the file, so an entry whose size or mtime moved is reloaded.
+class ContentCache {
+public:
+    // Immutable contents of one file, cheap to copy. Keeps its buffer or mapping alive, so it
+    // stays valid after eviction or invalidation. An invalid view means the file couldn't be read.
+    class View {
+    public:
+        View() = default;
+
+        bool isValid() const { return text_ || mapping_; }
+        explicit operator bool() const { return isValid(); }
+        std::string_view data() const { return data_; }
+        size_t size() const { return data_.size(); }
+        bool isMapped() const { return mapping_ != nullptr; }
+        std::string str() const { return std::string(data_); }
+        // As a text-mode stream would read it: on Windows "\r\n" becomes "\n".
+        std::string text() const;
+
+    private:
+        friend class ContentCache;
+        std::shared_ptr<const std::string> text_;
+        std::shared_ptr<const MappedFile> mapping_;
+        std::string_view data_;
+    };
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    explicit ContentCache(size_t capacityBytes = 8 * 1024 * 1024, size_t mapThreshold = 256 * 1024);
+
+    // mapLarge false reads large files too: a mapping faults if the file is truncated under it.
+    View read(const fs::path& path, bool mapLarge = true);
+
+    // Drops a cached file, called by writers so the next read can't see stale contents.
+    void invalidate(const fs::path& path);
+    // Drops every cached file below a directory.
+    void invalidateTree(const fs::path& directory);
+    void clear();
+
+    Stats getStats();
+
+private:
+    struct Entry {
+        std::string key;
+        std::uintmax_t size = 0;
+        fs::file_time_type mtime;
+        std::shared_ptr<const std::string> text;
+    };
+
+    static std::string makeKey(const fs::path& path);
+    void eraseEntry(std::list<Entry>::iterator it);
+    void evict();
+
+    const size_t capacityBytes_;
+    const size_t mapThreshold_;
+
+    std::mutex mutex_;
+    std::list<Entry> lru_; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries_;
+    size_t bytes_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+};
+
+#endif // CONTENT_CACHE_HPP
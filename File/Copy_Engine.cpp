@@ -0,0 +1,227 @@
+// Copy_Engine.cpp
+#include "Copy_Engine.hpp"
+#include <algorithm>
+#include <memory>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CopyEngine::CopyEngine(size_t workers) {
+    if (workers == 0) {
+        workers = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, kMaxWorkers);
+    }
+    // The caller of copy() also works, so one thread fewer is enough.
+    for (size_t i = 1; i < workers; ++i) {
+        workers_.emplace_back(&CopyEngine::workerLoop, this);
+    }
+}
+
+CopyEngine::~CopyEngine() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        stopping_ = true;
+    }
+    queueCv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+CopyEngine& CopyEngine::shared() {
+    static CopyEngine engine;
+    return engine;
+}
+
+void CopyEngine::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueCv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+            if (stopping_ && tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+CopyEngine::Stats CopyEngine::copy(const std::vector<Job>& jobs, const ProgressCallback& progress) {
+    struct Batch {
+        const std::vector<Job>* jobs = nullptr;
+        const ProgressCallback* progress = nullptr;
+        std::atomic<size_t> next{0};
+        std::chrono::steady_clock::time_point start;
+        std::mutex mutex;
+        std::condition_variable doneCv;
+        size_t running = 0;
+        Progress state;
+        Stats stats;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    batch->jobs = &jobs;
+    batch->progress = &progress;
+    batch->start = std::chrono::steady_clock::now();
+    batch->state.filesTotal = jobs.size();
+    for (const auto& job : jobs) batch->state.bytesTotal += job.size;
+
+    if (jobs.empty()) return batch->stats;
+
+    // Every runner pulls jobs off the shared index until the batch is drained.
+    auto runner = [batch]() {
+        for (size_t i = batch->next++; i < batch->jobs->size(); i = batch->next++) {
+            const Job& job = (*batch->jobs)[i];
+            std::uintmax_t bytes = 0;
+            Method method = Method::Buffered;
+            std::string error;
+            try {
+                method = copyFile(job.from, job.to, bytes);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            Stats& stats = batch->stats;
+            if (error.empty()) {
+                ++stats.filesCopied;
+                stats.bytesCopied += bytes;
+                if (method == Method::Reflink) ++stats.reflinked;
+                else if (method == Method::Buffered) ++stats.buffered;
+                else ++stats.kernelCopied;
+            } else {
+                ++stats.filesFailed;
+                if (stats.error.empty()) stats.error = error;
+            }
+
+            Progress& state = batch->state;
+            ++state.filesDone;
+            state.bytesDone += error.empty() ? bytes : job.size;
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch->start).count();
+            state.bytesPerSecond = seconds > 0.0 ? static_cast<double>(stats.bytesCopied) / seconds : 0.0;
+            if (*batch->progress) (*batch->progress)(state);
+        }
+
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if (--batch->running == 0) batch->doneCv.notify_all();
+    };
+
+    size_t helpers = std::min(workers_.size(), jobs.size() - 1);
+    batch->running = helpers + 1;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        for (size_t i = 0; i < helpers; ++i) tasks_.push(runner);
+    }
+    if (helpers == 1) queueCv_.notify_one();
+    else if (helpers > 1) queueCv_.notify_all();
+
+    runner();
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->doneCv.wait(lock, [&batch]() { return batch->running == 0; });
+
+    Stats stats = batch->stats;
+    auto elapsed = std::chrono::steady_clock::now() - batch->start;
+    stats.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    stats.bytesPerSecond = seconds > 0.0 ? static_cast<double>(stats.bytesCopied) / seconds : 0.0;
+    return stats;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+struct FileDescriptor {
+    int fd = -1;
+    explicit FileDescriptor(int value) : fd(value) {}
+    ~FileDescriptor() { if (fd >= 0) ::close(fd); }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+};
+
+[[noreturn]] void throwErrno(const char* what, const fs::path& from, const fs::path& to) {
+    throw fs::filesystem_error(what, from, to, std::error_code(errno, std::generic_category()));
+}
+
+// Errors that mean "not supported here", as opposed to a real I/O failure.
+bool isUnsupported(int error) {
+    return error == EXDEV || error == EINVAL || error == ENOSYS || error == EOPNOTSUPP ||
+           error == ENOTTY || error == EPERM || error == EBADF;
+}
+
+} // namespace
+
+CopyEngine::Method CopyEngine::copyFile(const fs::path& from, const fs::path& to, std::uintmax_t& bytesCopied) {
+    bytesCopied = 0;
+
+    FileDescriptor in(::open(from.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.fd < 0) throwErrno("cannot open source", from, to);
+
+    struct stat st {};
+    if (::fstat(in.fd, &st) != 0) throwErrno("cannot stat source", from, to);
+
+    FileDescriptor out(::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777));
+    if (out.fd < 0) throwErrno("cannot open target", from, to);
+
+#ifdef FICLONE
+    // Shares the extents on btrfs, XFS and friends: no data is copied at all.
+    if (::ioctl(out.fd, FICLONE, in.fd) == 0) {
+        bytesCopied = static_cast<std::uintmax_t>(st.st_size);
+        return Method::Reflink;
+    }
+#endif
+
+    // Copy inside the kernel; stops at EOF, so a file that grew meanwhile is copied whole.
+    Method method = Method::CopyFileRange;
+    while (true) {
+        ssize_t n = ::copy_file_range(in.fd, nullptr, out.fd, nullptr, 1 << 30, 0);
+        if (n > 0) {
+            bytesCopied += static_cast<std::uintmax_t>(n);
+            continue;
+        }
+        if (n == 0) return method;
+        if (errno == EINTR) continue;
+        if (!isUnsupported(errno)) throwErrno("copy_file_range failed", from, to);
+        break;
+    }
+
+    // Streaming fallback, picking up at the current offsets of both descriptors.
+    method = Method::Buffered;
+    thread_local std::unique_ptr<char[]> buffer(new char[kBufferSize]);
+    while (true) {
+        ssize_t n = ::read(in.fd, buffer.get(), kBufferSize);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throwErrno("read failed", from, to);
+        }
+        if (n == 0) return method;
+
+        for (ssize_t written = 0; written < n;) {
+            ssize_t w = ::write(out.fd, buffer.get() + written, static_cast<size_t>(n - written));
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                throwErrno("write failed", from, to);
+            }
+            written += w;
+        }
+        bytesCopied += static_cast<std::uintmax_t>(n);
+    }
+}
+
+#else
+
+CopyEngine::Method CopyEngine::copyFile(const fs::path& from, const fs::path& to, std::uintmax_t& bytesCopied) {
+    // CopyFile on Windows (and fcopyfile/sendfile elsewhere) already copies in the kernel.
+    fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+    bytesCopied = fs::file_size(to);
+    return Method::Platform;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef COPY_ENGINE_HPP
+#define COPY_ENGINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Copies batches of files on a small worker pool. On Linux each file is first reflinked
+// (FICLONE), then copied in the kernel with copy_file_range, and only falls back to a
+// streaming copy through a large buffer when neither is supported.
+class CopyEngine {
+public:
+    struct Job {
+        fs::path from;
+        fs::path to;
+        std::uintmax_t size = 0; // expected size, only used for progress
+    };
+
+    enum class Method { Reflink, CopyFileRange, Buffered, Platform };
+
+    struct Progress {
+        size_t filesDone = 0;
+        size_t filesTotal = 0;
+        std::uintmax_t bytesDone = 0;
+        std::uintmax_t bytesTotal = 0;
+        double bytesPerSecond = 0.0;
+    };
+
+    struct Stats {
+        size_t filesCopied = 0;
+        size_t filesFailed = 0;
+        std::uintmax_t bytesCopied = 0;
+        size_t reflinked = 0;
+        size_t kernelCopied = 0; // copy_file_range or the platform copy
+        size_t buffered = 0;
+        std::chrono::milliseconds elapsed{0};
+        double bytesPerSecond = 0.0;
+        std::string error; // first failure
+    };
+
+    // Called after every finished file, one call at a time.
+    using ProgressCallback = std::function<void(const Progress&)>;
+
+    // 0 workers picks the hardware concurrency, capped at kMaxWorkers.
+    explicit CopyEngine(size_t workers = 0);
+    ~CopyEngine();
+
+    CopyEngine(const CopyEngine&) = delete;
+    CopyEngine& operator=(const CopyEngine&) = delete;
+
+    // Copies every job, overwriting existing targets, and blocks until all are done.
+    // The calling thread works through the batch too. Safe to call from several threads.
+    Stats copy(const std::vector<Job>& jobs, const ProgressCallback& progress = {});
+
+    // Engine shared by the backup paths.
+    static CopyEngine& shared();
+
+    // Copies one file on the calling thread, throws fs::filesystem_error on failure.
+    static Method copyFile(const fs::path& from, const fs::path& to, std::uintmax_t& bytesCopied);
+
+    static constexpr size_t kMaxWorkers = 8;
+    static constexpr size_t kBufferSize = 1024 * 1024;
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::queue<std::function<void()>> tasks_;
+    bool stopping_ = false;
+};
+
+#endif // COPY_ENGINE_HPP
@@ -0,0 +1,100 @@
+#ifndef FAST_HASH_HPP
+#define FAST_HASH_HPP
+
+#include "Mapped_File.hpp"
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+// XXH64 (one-shot), used to fingerprint file contents for backups and caches.
+namespace fast_hash {
+
+namespace detail {
+    constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ull;
+    constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr std::uint64_t P3 = 0x165667B19E3779F9ull;
+    constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+    constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+    inline std::uint64_t rotl(std::uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    inline std::uint64_t read64(const unsigned char* p) { std::uint64_t v; std::memcpy(&v, p, 8); return v; }
+    inline std::uint32_t read32(const unsigned char* p) { std::uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    inline std::uint64_t round(std::uint64_t acc, std::uint64_t input) {
+        acc += input * P2;
+        acc = rotl(acc, 31);
+        return acc * P1;
+    }
+
+    inline std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t val) {
+        acc ^= round(0, val);
+        return acc * P1 + P4;
+    }
+}
+
+inline std::uint64_t hash64(const void* data, size_t len, std::uint64_t seed = 0) {
+    using namespace detail;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    std::uint64_t h;
+
+    if (len >= 32) {
+        const unsigned char* limit = end - 32;
+        std::uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+        do {
+            v1 = round(v1, read64(p)); p += 8;
+            v2 = round(v2, read64(p)); p += 8;
+            v3 = round(v3, read64(p)); p += 8;
+            v4 = round(v4, read64(p)); p += 8;
+        } while (p <= limit);
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    } else {
+        h = seed + P5;
+    }
+
+    h += static_cast<std::uint64_t>(len);
+    for (; p + 8 <= end; p += 8) {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * P1 + P4;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<std::uint64_t>(read32(p)) * P1;
+        h = rotl(h, 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= (*p) * P5;
+        h = rotl(h, 11) * P1;
+    }
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Hashes a whole file, nullopt if it can't be read. Read rather than mapped: the files hashed
+// for backups and indexes may be truncated and rewritten in place meanwhile.
+inline std::optional<std::uint64_t> hashFile(const fs::path& path) {
+    std::string contents;
+    if (!readWholeFile(path, contents)) return std::nullopt;
+    return hash64(contents.data(), contents.size());
+}
+
+inline std::string toHex(std::uint64_t value) {
+    static const char* digits = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i, value >>= 4) hex[i] = digits[value & 0xF];
+    return hex;
+}
+
+} // namespace fast_hash
+
+#endif // FAST_HASH_HPP
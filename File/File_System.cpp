@@ -1,23 +1,47 @@
 // File_System.cpp
 #include "File_System.hpp"
+#include "Log_Modules.hpp"
+#include "Snapshot_Backup.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <iostream>
-#include <cstdlib>
 
 FileSystem::FileSystem(const std::string& appName, size_t maxLogSize, const std::string& logFileBaseName)
     : appName_(appName), maxLogSize_(maxLogSize), baseLogFileName_(logFileBaseName)
 {
     appDataDir_ = fs::current_path() / (appName_ + "_data");
     backupDir_ = appDataDir_ / "backup";
-    activeLogFileName_ = baseLogFileName_ + "_" + currentDate() + ".txt";
+    activeLogFileName_ = baseLogFileName_ + "_" + currentDate() + logExtension_;
     logFilePath_ = appDataDir_ / activeLogFileName_;
+    ringFilePath_ = appDataDir_ / (baseLogFileName_ + LogRingBuffer::kFileExtension);
+
+    logCompressor_.setCompletionCallback([this](const fs::path& source, const fs::path& output, bool ok,
+                                                std::uint64_t bytesIn, std::uint64_t bytesOut, const std::string& error) {
+        bool compressed = output.extension() == LogCompressor::kExtension;
+        if (!ok) {
+            log((compressed ? "Compressing " : "Indexing ") + source.filename().string() + " failed: " + error, LogLevel::Warn);
+        } else if (compressed) {
+            log("Compressed " + source.filename().string() + ": " + std::to_string(bytesIn) + " -> " +
+                std::to_string(bytesOut) + " bytes");
+        } else {
+            log("Indexed " + source.filename().string() + ": " + std::to_string(bytesIn) + " bytes");
+        }
+    });
 }
 
 FileSystem::~FileSystem() {
+    LogModules::clearTarget(this);
     stopMonitoring();
     stopAsyncBackup();
+    // Nothing logs past this point, so what came in after the monitor's last drain goes to the
+    // file now instead of being taken for crash leftovers on the next start.
+    fileWatcher_.stop();
+    logCompressor_.stop();
+    drainLogRing();
 }
 
 std::string FileSystem::getAppDataPath() const {
@@ -33,6 +57,7 @@ bool FileSystem::initialize() {
             std::ofstream ofs(logFilePath_);
             if (!ofs) return false;
         }
+        recoverLogRing();
         return true;
     } catch (const std::exception& e) {
         std::cerr << "Initialize failed: " << e.what() << "\n";
@@ -46,6 +71,8 @@ bool FileSystem::createFile(const std::string& filename, const std::string& cont
         std::ofstream ofs(filePath);
         if (!ofs) return false;
         ofs << content;
+        ofs.close();
+        contentCache_.invalidate(filePath);
         return true;
     } catch (...) {
         return false;
@@ -53,25 +80,34 @@ bool FileSystem::createFile(const std::string& filename, const std::string& cont
 }
 
 std::string FileSystem::readFile(const std::string& filename) {
+    // Copied out anyway, so nothing is gained by mapping a file createFile may rewrite in place.
+    return readFileView(filename, false).text();
+}
+
+ContentCache::View FileSystem::readFileView(const std::string& filename, bool mapLarge) {
     try {
-        fs::path filePath = appDataDir_ / filename;
-        std::ifstream ifs(filePath);
-        if (!ifs) return "";
-        std::ostringstream ss;
-        ss << ifs.rdbuf();
-        return ss.str();
+        return contentCache_.read(appDataDir_ / filename, mapLarge);
     } catch (...) {
-        return "";
+        return {};
     }
 }
 
 bool FileSystem::backupFiles() {
     try {
-        for (const auto& entry : fs::directory_iterator(appDataDir_)) {
-            if (entry.is_regular_file() && entry.path() != logFilePath_) {
-                fs::copy(entry.path(), backupDir_ / entry.path().filename(),
-                         fs::copy_options::overwrite_existing);
-            }
+        // Top level files only (backupDir_ lives inside appDataDir_), minus the log being written.
+        SnapshotBackup snapshots(backupDir_, appName_);
+        auto result = snapshots.create(appDataDir_, false, [this](const fs::path& relative) {
+            fs::path path = appDataDir_ / relative;
+            return path != logFilePath_ && path != ringFilePath_;
+        });
+        if (!result.ok) {
+            std::cerr << "Backup failed: " << result.error << "\n";
+            return false;
+        }
+        if (!result.unchanged) {
+            log("Backup snapshot " + result.snapshotPath.filename().string() + ": " +
+                std::to_string(result.filesCopied) + " copied (" + std::to_string(result.bytesCopied) + " bytes), " +
+                std::to_string(result.filesLinked) + " linked");
         }
         return true;
     } catch (...) {
@@ -83,22 +119,54 @@ void FileSystem::startMonitoring() {
     if (isMonitoring_) return;
     isMonitoring_ = true;
     monitorThread_ = std::thread(&FileSystem::monitorDirectory, this);
+
+    // Top level only, like backupFiles; our own logs change constantly and aren't interesting.
+    std::string logPrefix = baseLogFileName_ + "_";
+    fs::path ringName = ringFilePath_.filename();
+    dataWatch_ = fileWatcher_.subscribe(appDataDir_, false,
+        [this](const std::vector<FileWatcher::Event>& events) { onDataChanged(events); },
+        [logPrefix, ringName](const fs::path& relative) {
+            return relative.filename().string().rfind(logPrefix, 0) != 0 && relative.filename() != ringName;
+        });
+    if (dataWatch_ == 0) log("File watching unavailable, changes on disk go unnoticed", LogLevel::Warn);
 }
 
 void FileSystem::stopMonitoring() {
     if (!isMonitoring_) return;
-    isMonitoring_ = false;
+    FileWatcher::SubscriptionId watch = dataWatch_.exchange(0);
+    if (watch != 0) fileWatcher_.unsubscribe(watch);
+    {
+        std::lock_guard<std::mutex> lock(monitorMutex_);
+        isMonitoring_ = false;
+    }
     monitorCv_.notify_all();
     if (monitorThread_.joinable()) monitorThread_.join();
 }
 
+void FileSystem::onDataChanged(const std::vector<FileWatcher::Event>& events) {
+    dataChanged_ = true;
+    for (const auto& event : events) {
+        if (event.changes & FileWatcher::Overflow) {
+            contentCache_.invalidateTree(event.path);
+            log("File watcher overflowed, dropped cached contents", LogLevel::Warn);
+            continue;
+        }
+        if (event.isDirectory) continue;
+        contentCache_.invalidate(event.path);
+
+        const char* change = (event.changes & FileWatcher::Removed) ? "removed"
+                           : (event.changes & FileWatcher::Created) ? "created" : "changed";
+        logf(LOG_FORMAT_ID("File {}: {}"), LogLevel::Info, change, event.path.filename().string());
+    }
+}
+
 void FileSystem::startAsyncBackup() {
     if (isBackingUp_) return;
     isBackingUp_ = true;
     backupThread_ = std::thread([this]() {
         while (isBackingUp_) {
-            backupFiles();
-            compressOldLogs();
+            // With a watch in place, a quiet data directory needs no snapshot pass at all.
+            if (dataWatch_ == 0 || dataChanged_.exchange(false)) backupFiles();
             std::this_thread::sleep_for(std::chrono::seconds(30));
         }
     });
@@ -111,45 +179,215 @@ void FileSystem::stopAsyncBackup() {
 }
 
 void FileSystem::log(const std::string& message, LogLevel level) {
-    std::string timestamp = currentTimestamp();
-    std::string levelStr = logLevelToString(level);
-    std::string json = toJsonLog(timestamp, levelStr, message);
+    pushLog(level, Record_Text, message);
+}
 
-    {
-        std::lock_guard<std::mutex> lock(logMutex_);
-        logQueue_.push(json);
+void FileSystem::pushLog(LogLevel level, std::uint8_t kind, std::string_view payload) {
+    std::int64_t ticks = std::chrono::system_clock::now().time_since_epoch().count();
+    // Blocking for room only makes sense while the monitor thread is draining.
+    logRing_.push(static_cast<std::uint8_t>(level), kind, ticks, payload, isMonitoring_.load(std::memory_order_relaxed));
+
+    // Pairs with the fence in monitorDirectory: either the writer sees the record before it
+    // sleeps, or we see writerSleeping_. Notifying under the mutex means the writer is then
+    // either still checking (and will see the record) or already waiting. Only the producer that
+    // clears the flag notifies; the woken writer drains whatever the others pushed meanwhile.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (writerSleeping_.load(std::memory_order_relaxed) && writerSleeping_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(monitorMutex_);
+        monitorCv_.notify_one();
     }
-    monitorCv_.notify_all();
+}
+
+void FileSystem::recoverLogRing() {
+    if (logRing_.isMapped()) return;
+    std::vector<LogRingBuffer::Record> records;
+    std::vector<std::string> formats;
+    if (!logRing_.mapFile(ringFilePath_, &records, &formats)) {
+        log("Log ring file unavailable (in use by another instance?), a crash loses log lines not yet written",
+            LogLevel::Warn);
+        return;
+    }
+    mirroredFormats_ = 0;
+    mirrorFormats();
+    if (records.empty()) return;
+
+    log("Recovered " + std::to_string(records.size()) + " log lines a previous run didn't write", LogLevel::Warn);
+    for (const auto& record : records) {
+        // Format ids are per process, so render with the previous run's formats here.
+        std::string message = record.payload;
+        if (record.kind == Record_Format) {
+            std::uint32_t id = LogFormatRegistry::kInvalidId;
+            if (record.payload.size() >= sizeof(id)) std::memcpy(&id, record.payload.data(), sizeof(id));
+            if (id < formats.size() && !formats[id].empty()) {
+                message = log_format::formatMessage(formats[id].c_str(), std::string_view(record.payload).substr(sizeof(id)));
+            } else {
+                message = "<unknown log format " + std::to_string(id) + ">";
+            }
+        }
+        logRing_.push(record.level, Record_Text, record.timestamp, message, false);
+    }
+}
+
+void FileSystem::mirrorFormats() {
+    std::lock_guard<std::mutex> lock(formatMirrorMutex_);
+    std::uint32_t id = mirroredFormats_.load(std::memory_order_relaxed);
+    std::uint32_t count = LogFormatRegistry::size();
+    for (; id < count; ++id) {
+        const char* format = LogFormatRegistry::lookup(id);
+        if (!format) break; // still being registered, its first logf call mirrors it
+        if (!logRing_.addString(id, format)) {
+            // Table full: later formats recover as unknown, don't retry on every call.
+            id = LogFormatRegistry::kMaxFormats;
+            break;
+        }
+    }
+    mirroredFormats_.store(id, std::memory_order_relaxed);
+}
+
+void FileSystem::setBinaryLogging(bool enabled) {
+    binaryLog_ = enabled;
+    logExtension_ = enabled ? LogBinaryFormat::kExtension : ".txt";
+    activeLogFileName_ = baseLogFileName_ + "_" + currentDate() + logExtension_;
+    logFilePath_ = appDataDir_ / activeLogFileName_;
+}
+
+void FileSystem::setConsoleEcho(bool enabled, size_t maxLinesPerSecond) {
+    consoleSink_.setEnabled(enabled);
+    consoleSink_.setRateLimit(maxLinesPerSecond);
+}
+
+void FileSystem::setLogCompression(bool enabled, int level) {
+    logCompressor_.setCompressionEnabled(enabled);
+    logCompressor_.setLevel(level);
 }
 
 void FileSystem::monitorDirectory() {
+    if (!openLogWriter()) {
+        std::cerr << "Failed to open log file: " << logFilePath_ << "\n";
+    }
+    // Rotated logs a previous run didn't get to compress; after this only rotations queue work.
+    compressOldLogs();
+
     while (isMonitoring_) {
-        std::unique_lock<std::mutex> lock(logMutex_);
-        monitorCv_.wait_for(lock, std::chrono::seconds(1), [this]() {
-            return !logQueue_.empty() || !isMonitoring_;
-        });
+        {
+            // Sleeps until a producer notifies or the flush interval is up; with nothing
+            // buffered that is indefinitely. File changes are the watcher's business.
+            std::unique_lock<std::mutex> lock(monitorMutex_);
+            writerSleeping_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (isMonitoring_ && logRing_.empty()) {
+                auto flushDue = logWriter_.nextFlushDue();
+                if (flushDue == (std::chrono::steady_clock::time_point::max)()) monitorCv_.wait(lock);
+                else monitorCv_.wait_until(lock, flushDue);
+            }
+            writerSleeping_.store(false, std::memory_order_relaxed);
+        }
         if (!isMonitoring_) break;
 
-        processLogQueue();
-        watchFilesForChanges();
-        if (needsLogRotation()) rotateLogFile();
+        bool wrote = processLogQueue();
+        if (wrote && needsLogRotation()) rotateLogFile();
     }
+
+    processLogQueue();
+    // A failed flush leaves the records in the ring file for the next start to recover.
+    if (checkLogWrite(logWriter_.flush(true))) logRing_.markPersisted();
+    logWriter_.close();
 }
 
-void FileSystem::processLogQueue() {
-    std::ofstream ofs(logFilePath_, std::ios::app);
-    while (!logQueue_.empty()) {
-        ofs << logQueue_.front() << "\n";
-        std::cout << logQueue_.front() << "\n"; // live console tail
-        logQueue_.pop();
+void FileSystem::drainLogRing() {
+    if (logRing_.empty() && logRing_.unpersistedSlots() == 0) return;
+    bool opened = logWriter_.isOpen();
+    if (!opened && !openLogWriter()) return;
+    processLogQueue();
+    if (checkLogWrite(logWriter_.flush(true))) logRing_.markPersisted();
+    if (!opened) logWriter_.close();
+}
+
+bool FileSystem::openLogWriter() {
+    if (!logWriter_.open(logFilePath_)) return false;
+    if (binaryLog_) {
+        // Format definitions are repeated per file so every segment decodes on its own.
+        binaryFormat_.reset();
+        if (logWriter_.size() == 0) logWriter_.appendRaw(LogBinaryFormat::header(), false);
     }
+    return true;
+}
+
+void FileSystem::writeLogRecord(LogLevel level, std::uint8_t kind, std::int64_t ticks, std::string_view payload,
+                                std::chrono::steady_clock::time_point now) {
+    bool important = level == LogLevel::Warn || level == LogLevel::Error;
+    if (binaryLog_) {
+        binaryRecord_.clear();
+        if (kind == Record_Format) binaryFormat_.encodeEntry(binaryRecord_, static_cast<std::uint8_t>(level), ticks, payload);
+        else binaryFormat_.encodeMessage(binaryRecord_, static_cast<std::uint8_t>(level), ticks, payload);
+        logWriter_.appendRaw(binaryRecord_, important);
+        if (!consoleSink_.isEnabled()) return;
+    }
+
+    std::string message = kind == Record_Format ? log_format::formatMessage(payload) : std::string(payload);
+    std::string line = lineFormatter_.jsonLine(ticks, logLevelToString(level), message);
+    if (!binaryLog_) logWriter_.append(line, important);
+    consoleSink_.write(line, now);
+}
+
+bool FileSystem::processLogQueue() {
+    auto now = std::chrono::steady_clock::now();
+    auto write = [&](std::uint8_t level, std::uint8_t kind, std::int64_t timestamp, std::string_view payload) {
+        writeLogRecord(static_cast<LogLevel>(level), kind, timestamp, payload, now);
+    };
+    size_t drained = 0, batch = 0;
+    do {
+        batch = logRing_.drain(write, kDrainBatch);
+        drained += batch;
+        // The mapped ring holds drained records until they are in the file; flush before
+        // the writer's buffer pins half of it and producers run out of room.
+        if (logRing_.unpersistedSlots() >= logRing_.capacity() / 2) checkLogWrite(logWriter_.flush());
+        releaseLogRing();
+    } while (batch == kDrainBatch);
+
+    std::uint64_t dropped = logRing_.takeDroppedSinceReport();
+    if (dropped > 0 && logRing_.getPolicy() == LogRingBuffer::OverflowPolicy::Count) {
+        std::int64_t ticks = std::chrono::system_clock::now().time_since_epoch().count();
+        writeLogRecord(LogLevel::Warn, Record_Text, ticks, "Log ring full, dropped " + std::to_string(dropped) + " messages", now);
+    }
+
+    consoleSink_.flush();
+    checkLogWrite(logWriter_.flushIfDue(now));
+    // Reported once the file takes writes again, a warning appended before that would be dropped
+    // too. It goes out with the next flush.
+    std::uint64_t lost = logWriteFailed_ ? 0 : logWriter_.takeDroppedSinceReport();
+    if (lost > 0) {
+        std::int64_t ticks = std::chrono::system_clock::now().time_since_epoch().count();
+        writeLogRecord(LogLevel::Warn, Record_Text, ticks, "Log file not writable, dropped " + std::to_string(lost) + " messages", now);
+    }
+    releaseLogRing();
+    return drained > 0;
+}
+
+void FileSystem::releaseLogRing() {
+    // While writes fail nothing reaches the file, and holding the slots would fill the ring and
+    // block every thread that logs. The records are in the writer's buffer by now; they lose
+    // their crash copy but are still written once the file takes writes again.
+    if (logWriter_.buffered() == 0 || logWriteFailed_) logRing_.markPersisted();
+}
+
+bool FileSystem::checkLogWrite(bool ok) {
+    if (!ok && !logWriteFailed_) {
+        logWriteFailed_ = true;
+        std::cerr << "Log write failed, keeping " << logWriter_.buffered() << " bytes to retry: " << logFilePath_ << "\n";
+    } else if (ok && logWriteFailed_ && logWriter_.buffered() == 0) {
+        logWriteFailed_ = false;
+        std::cerr << "Log writes resumed: " << logFilePath_ << "\n";
+    }
+    return ok;
 }
 
 bool FileSystem::needsLogRotation() {
     try {
         std::string today = currentDate();
-        std::string expectedName = baseLogFileName_ + "_" + today + ".txt";
+        std::string expectedName = baseLogFileName_ + "_" + today + logExtension_;
         if (activeLogFileName_ != expectedName) return true;
+        if (logWriter_.isOpen()) return logWriter_.size() >= maxLogSize_;
         if (fs::exists(logFilePath_) && fs::file_size(logFilePath_) >= maxLogSize_) return true;
         return false;
     } catch (...) {
@@ -158,34 +396,46 @@ bool FileSystem::needsLogRotation() {
 }
 
 void FileSystem::rotateLogFile() {
+    // close() drops what it can't write, so keep the current file until writes go through again.
+    if (logWriter_.isOpen() && !checkLogWrite(logWriter_.flush(logWriter_.syncPending()))) return;
     try {
-        std::string todayName = baseLogFileName_ + "_" + currentDate() + ".txt";
+        // Everything buffered belongs to the file being rotated out.
+        logWriter_.close();
+
+        std::string todayName = baseLogFileName_ + "_" + currentDate() + logExtension_;
         if (activeLogFileName_ != todayName) {
+            if (fs::exists(logFilePath_)) logCompressor_.enqueue(logFilePath_);
             activeLogFileName_ = todayName;
             logFilePath_ = appDataDir_ / activeLogFileName_;
-            std::ofstream ofs(logFilePath_);
         } else {
-            std::string rotated = baseLogFileName_ + "_" + currentDate() + "_" + currentTimestamp() + ".txt";
-            fs::rename(logFilePath_, appDataDir_ / rotated);
-            std::ofstream ofs(logFilePath_);
+            // Several rotations can land in the same second; never rename over an earlier one.
+            std::string stem = baseLogFileName_ + "_" + currentDate() + "_" + currentTimestamp();
+            // The archive counts too, the compressor removes the uncompressed file once it's done.
+            auto taken = [](fs::path path) { return fs::exists(path) || fs::exists(path += LogCompressor::kExtension); };
+            fs::path rotated = appDataDir_ / (stem + logExtension_);
+            for (int n = 1; taken(rotated); ++n) rotated = appDataDir_ / (stem + "_" + std::to_string(n) + logExtension_);
+            fs::rename(logFilePath_, rotated);
+            logCompressor_.enqueue(rotated);
         }
+        openLogWriter();
     } catch (const std::exception& e) {
         std::cerr << "Rotation failed: " << e.what() << "\n";
+        if (!logWriter_.isOpen()) openLogWriter();
     }
 }
 
 void FileSystem::compressOldLogs() {
+    bool compress = logCompressor_.isCompressionEnabled();
     try {
-        for (const auto& entry : fs::directory_iterator(appDataDir_)) {
-            if (entry.is_regular_file()) {
-                auto path = entry.path();
-                if (path.extension() == ".txt" && path.filename() != activeLogFileName_) {
-                    std::string zipName = path.stem().string() + ".zip";
-                    std::string cmd = "zip -j \"" + (appDataDir_ / zipName).string() + "\" \"" + path.string() + "\"";
-                    if (std::system(cmd.c_str()) == 0) {
-                        fs::remove(path);
-                    }
-                }
+        std::error_code ec;
+        for (fs::directory_iterator it(appDataDir_, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            const fs::path& path = it->path();
+            auto extension = path.extension();
+            bool isLog = extension == ".txt" || extension == LogBinaryFormat::kExtension;
+            // Only this FileSystem's logs, not every text file that lives in the data directory.
+            if (isLog && path.filename() != activeLogFileName_ && path.filename().string().rfind(baseLogFileName_ + "_", 0) == 0) {
+                if (compress || !LogIndex::loadFor(path)) logCompressor_.enqueue(path);
             }
         }
     } catch (const std::exception& e) {
@@ -193,24 +443,55 @@ void FileSystem::compressOldLogs() {
     }
 }
 
-void FileSystem::watchFilesForChanges() {
+std::vector<fs::path> FileSystem::logSegments() const {
+    std::vector<std::pair<std::int64_t, fs::path>> segments;
+    std::error_code ec;
+    std::string prefix = baseLogFileName_ + "_";
+    for (fs::directory_iterator it(appDataDir_, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) continue;
+        const fs::path& path = it->path();
+        if (path.filename().string().rfind(prefix, 0) != 0) continue;
+
+        fs::path plain = LogIndex::isCompressed(path) ? path.parent_path() / path.stem() : path;
+        auto extension = plain.extension();
+        if (extension != ".txt" && extension != LogBinaryFormat::kExtension) continue;
+        if (LogIndex::isCompressed(path)) {
+            // Mid-compression both exist; the archive wins once its index is written.
+            if (fs::exists(plain, ec) && !LogIndex::loadFor(path)) continue;
+        } else {
+            fs::path archive = path;
+            archive += LogCompressor::kExtension;
+            if (fs::exists(archive, ec) && LogIndex::loadFor(archive)) continue;
+        }
+
+        // Segments without a timed record sort first, they can't match a time range anyway.
+        auto start = LogIndex::segmentStart(path);
+        segments.emplace_back(start.value_or((std::numeric_limits<std::int64_t>::min)()), path);
+    }
+    std::sort(segments.begin(), segments.end());
+
+    std::vector<fs::path> paths;
+    paths.reserve(segments.size());
+    for (auto& segment : segments) paths.push_back(std::move(segment.second));
+    return paths;
+}
+
+size_t FileSystem::queryLogs(const LogQuery& query, const LogIndex::EntrySink& sink, LogIndex::QueryStats* stats) const {
+    std::int64_t from = query.from.time_since_epoch().count();
+    std::int64_t to = query.to.time_since_epoch().count();
+    size_t matched = 0;
     try {
-        for (const auto& entry : fs::directory_iterator(appDataDir_)) {
-            if (entry.is_regular_file()) {
-                auto path = entry.path();
-                auto currentTime = fs::last_write_time(path);
-                auto it = fileTimes_.find(path.string());
-                if (it == fileTimes_.end()) {
-                    fileTimes_[path.string()] = currentTime;
-                } else if (currentTime != it->second) {
-                    it->second = currentTime;
-                    std::cout << "File changed: " << path.filename() << "\n";
-                }
-            }
+        for (const auto& segment : logSegments()) {
+            bool more = LogIndex::querySegment(segment, from, to, query.levels, [&](const LogIndex::Entry& entry) {
+                ++matched;
+                return sink(entry);
+            }, stats);
+            if (!more) break;
         }
-    } catch (...) {
-        // ignore errors
+    } catch (const std::exception& e) {
+        std::cerr << "Log query failed: " << e.what() << "\n";
     }
+    return matched;
 }
 
 bool FileSystem::createDirectoriesIfNotExist(const fs::path& path) {
@@ -252,19 +533,11 @@ std::string FileSystem::currentDate() const {
 
 std::string FileSystem::logLevelToString(LogLevel level) const {
     switch (level) {
-        case LogLevel::INFO: return "INFO";
-        case LogLevel::WARN: return "WARN";
-        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Trace: return "TRACE";
     }
     return "UNKNOWN";
 }
-
-std::string FileSystem::toJsonLog(const std::string& timestamp, const std::string& level, const std::string& message) const {
-    std::ostringstream ss;
-    ss << "{"
-       << "\"timestamp\":\"" << timestamp << "\","
-       << "\"level\":\"" << level << "\","
-       << "\"message\":\"" << message << "\""
-       << "}";
-    return ss.str();
-}
@@ -1,21 +1,32 @@
 #ifndef FILE_SYSTEM_HPP
 #define FILE_SYSTEM_HPP
 
+#include "Content_Cache.hpp"
+#include "File_Watcher.hpp"
+#include "Log_Compressor.hpp"
+#include "Log_Format.hpp"
+#include "Log_Index.hpp"
+#include "Log_Ring_Buffer.hpp"
+#include "Log_Writer.hpp"
 #include <string>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <queue>
 #include <fstream>
 #include <filesystem>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
 #include <unordered_map>
 
 namespace fs = std::filesystem;
 
 class FileSystem {
 public:
-    enum class LogLevel { INFO, WARN, ERROR };
+    // Values are stored in the ring and in binary logs, so new levels go at the end.
+    // LogModules orders them by severity.
+    enum class LogLevel { Info, Warn, Error, Debug, Trace };
 
     FileSystem(const std::string& appName, size_t maxLogSize, const std::string& logFileBaseName = "log");
     ~FileSystem();
@@ -26,18 +37,69 @@ public:
     FileSystem& operator=(FileSystem&&) = delete;
 
     std::string getAppDataPath() const;
+    // Creates the data directory and maps the log ring to <base>.ring in it, so queued log lines
+    // survive a crash. Lines a crashed run left there are appended to the log first.
+    // Call before logging from other threads.
     bool initialize();
     bool createFile(const std::string& filename, const std::string& content);
+    // Text-mode contents, like reading through an ifstream.
     std::string readFile(const std::string& filename);
+    // Zero-copy read: cached for small files, a read-only mapping for large ones unless mapLarge
+    // is false. Only map files no one truncates in place while the view is alive.
+    ContentCache::View readFileView(const std::string& filename, bool mapLarge = true);
     bool backupFiles();
 
+    // Starts the log writer and watches the top of the data directory: changed files are dropped
+    // from the content cache, logged, and mark the next backup as needed.
     void startMonitoring();
     void stopMonitoring();
 
+    // Shared event-driven watcher, for anything else that wants to react to changes on disk.
+    FileWatcher& getFileWatcher() { return fileWatcher_; }
+
     void startAsyncBackup();
     void stopAsyncBackup();
 
-    void log(const std::string& message, LogLevel level = LogLevel::INFO);
+    // Copies the message and a raw timestamp into the log ring; formatting and file I/O
+    // happen on the monitor thread. Never takes a lock unless the policy is Block and the ring is full.
+    void log(const std::string& message, LogLevel level = LogLevel::Info);
+
+    // Deferred formatting: only the format id and the raw arguments are copied, the "{}"
+    // placeholders are filled in on the monitor thread, or by the decoder for binary logs.
+    //   logf(LOG_FORMAT_ID("Copied {} files in {} ms"), LogLevel::Info, count, ms);
+    template<typename... Args>
+    void logf(std::uint32_t formatId, LogLevel level, const Args&... args);
+
+    // Writes records as LogBinaryFormat (.rlog) instead of JSON lines, call before initialize.
+    // LogBinaryFormat::decode turns them back into the same JSON lines.
+    void setBinaryLogging(bool enabled);
+    bool isBinaryLogging() const { return binaryLog_; }
+
+    void setLogOverflowPolicy(LogRingBuffer::OverflowPolicy policy) { logRing_.setPolicy(policy); }
+    std::uint64_t getDroppedLogCount() const { return logRing_.getDroppedCount(); }
+
+    // Writer settings, call before startMonitoring. The log file stays open while monitoring.
+    void setLogFlushPolicy(const LogWriter::FlushPolicy& policy) { logWriter_.setPolicy(policy); }
+    void setConsoleEcho(bool enabled, size_t maxLinesPerSecond = 100);
+
+    // Rotated logs are gzip-compressed in the background as each rotation happens (on by default).
+    // Either way each rotated log gets a LogIndex sidecar for queryLogs.
+    void setLogCompression(bool enabled, int level = 6);
+    LogCompressor::Stats getLogCompressionStats() const { return logCompressor_.getStats(); }
+
+    struct LogQuery {
+        std::chrono::system_clock::time_point from = (std::chrono::system_clock::time_point::min)();
+        std::chrono::system_clock::time_point to = (std::chrono::system_clock::time_point::max)();
+        std::uint32_t levels = ~0u; // levelBit(Warn) | levelBit(Error) for problems only
+
+        static std::uint32_t levelBit(LogLevel level) { return 1u << static_cast<unsigned>(level); }
+    };
+
+    // Streams this FileSystem's log entries in [from, to] with a matching level, oldest segment
+    // first, until the sink returns false. Rotated segments are read through their index, only
+    // the blocks that can match; the active log is scanned up to its last flush.
+    // Returns the number of entries handed to the sink. Safe to call from any thread.
+    size_t queryLogs(const LogQuery& query, const LogIndex::EntrySink& sink, LogIndex::QueryStats* stats = nullptr) const;
 
 private:
     const std::string appName_;
@@ -45,34 +107,99 @@ private:
     fs::path appDataDir_;
     fs::path backupDir_;
     fs::path logFilePath_;
+    fs::path ringFilePath_;
 
     std::string baseLogFileName_;
     std::string activeLogFileName_;
+    std::string logExtension_ = ".txt";
+    bool binaryLog_ = false;
 
     std::atomic<bool> isMonitoring_{false};
     std::atomic<bool> isBackingUp_{false};
 
     std::thread monitorThread_;
     std::thread backupThread_;
-    std::mutex logMutex_;
-    std::condition_variable monitorCv_;
-    std::queue<std::string> logQueue_;
 
-    std::unordered_map<std::string, fs::file_time_type> fileTimes_;
+    // Producers only touch logRing_, and take monitorMutex_ to notify only when the writer sleeps.
+    LogRingBuffer logRing_;
+    std::mutex monitorMutex_;
+    std::condition_variable monitorCv_;
+    std::atomic<bool> writerSleeping_{false};
+    // Format ids below this are in the ring file, kMaxFormats while it isn't mapped.
+    std::atomic<std::uint32_t> mirroredFormats_{LogFormatRegistry::kMaxFormats};
+    std::mutex formatMirrorMutex_;
+
+    // Monitor thread only
+    LogWriter logWriter_;
+    LogConsoleSink consoleSink_;
+    LogLineFormatter lineFormatter_;
+    LogBinaryFormat binaryFormat_;
+    std::string binaryRecord_;
+    bool logWriteFailed_ = false;
+
+
+    ContentCache contentCache_;
+
+    // Declared after logRing_ so it's joined before the ring its completion logs go to is destroyed.
+    LogCompressor logCompressor_;
+
+    // Same for the watcher: its callbacks log and touch contentCache_.
+    FileWatcher fileWatcher_;
+    // Read by the backup thread, set and cleared by start/stopMonitoring.
+    std::atomic<FileWatcher::SubscriptionId> dataWatch_{0};
+    // Set by the watcher, cleared by the backup thread; starts set so the first backup always runs.
+    std::atomic<bool> dataChanged_{true};
+
+    // Ring record kinds: plain text, or a format id followed by encoded arguments.
+    enum LogRecordKind : std::uint8_t { Record_Text = 0, Record_Format = 1 };
+
+    void pushLog(LogLevel level, std::uint8_t kind, std::string_view payload);
+    // Maps the ring file and queues what the previous run left in it.
+    void recoverLogRing();
+    // Writes out whatever is left in the ring once monitoring has stopped.
+    void drainLogRing();
+    // Copies newly registered formats into the ring file, so recovered logf records still render.
+    void mirrorFormats();
 
     void monitorDirectory();
-    void processLogQueue();
+    // Opens logFilePath_, starting a new binary log with its header
+    bool openLogWriter();
+    void writeLogRecord(LogLevel level, std::uint8_t kind, std::int64_t ticks, std::string_view payload,
+                        std::chrono::steady_clock::time_point now);
+    // Drains the ring into the writer and flushes per policy, returns whether anything was drained
+    bool processLogQueue();
+    static constexpr size_t kDrainBatch = 256;
+    // Reports the first failed flush and the recovery, not every retry; returns ok.
+    bool checkLogWrite(bool ok);
+    // Frees the ring slots of drained records once they are written, or right away while writes fail
+    void releaseLogRing();
     bool needsLogRotation();
     void rotateLogFile();
 
+    // Queues rotated logs an earlier run left uncompressed or unindexed, once per monitoring start.
     void compressOldLogs();
-    void watchFilesForChanges();
+    // Rotated and active logs of this FileSystem, oldest first.
+    std::vector<fs::path> logSegments() const;
+    void onDataChanged(const std::vector<FileWatcher::Event>& events);
 
     bool createDirectoriesIfNotExist(const fs::path& path);
     std::string currentTimestamp() const;
     std::string currentDate() const;
     std::string logLevelToString(LogLevel level) const;
-    std::string toJsonLog(const std::string& timestamp, const std::string& level, const std::string& message) const;
 };
 
+template<typename... Args>
+void FileSystem::logf(std::uint32_t formatId, LogLevel level, const Args&... args) {
+    // Reused per thread so steady-state logging doesn't allocate before the ring copy.
+    thread_local std::string payload;
+    payload.clear();
+    log_format::encodeFormatId(payload, formatId);
+    (log_format::encodeArg(payload, args), ...);
+    // First use of a format since the ring file was mapped, rare.
+    if (formatId >= mirroredFormats_.load(std::memory_order_relaxed) && formatId < LogFormatRegistry::kMaxFormats) {
+        mirrorFormats();
+    }
+    pushLog(level, Record_Format, payload);
+}
+
 #endif // FILE_SYSTEM_HPP
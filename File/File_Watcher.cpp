@@ -0,0 +1,506 @@
+// File_Watcher.cpp
+#include "File_Watcher.hpp"
+#include <algorithm>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+struct FileWatcher::Subscription {
+    SubscriptionId id = 0;
+    fs::path root;
+    std::string rootKey;
+    bool recursive = false;
+    Callback callback;
+    Filter filter;
+    bool armed = false; // set by the watcher thread before the request is marked reconciled
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE directory = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped{};
+    std::vector<DWORD> buffer; // ReadDirectoryChangesW wants DWORD alignment
+#endif
+};
+
+namespace {
+
+// Absolute, normalized, '/' separated and without a trailing separator; used for prefix tests.
+std::string keyOf(const fs::path& path) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(path, ec);
+    std::string key = (ec ? path : absolute).lexically_normal().generic_string();
+    while (key.size() > 1 && key.back() == '/') key.pop_back();
+    return key;
+}
+
+bool isUnder(const std::string& key, const std::string& directory) {
+    return key.size() > directory.size() && key.compare(0, directory.size(), directory) == 0 && key[directory.size()] == '/';
+}
+
+std::string parentOf(const std::string& key) {
+    size_t slash = key.find_last_of('/');
+    return slash == std::string::npos ? std::string() : key.substr(0, slash);
+}
+
+} // namespace
+
+FileWatcher::FileWatcher(std::chrono::milliseconds coalesceWindow) : window_(coalesceWindow) {
+#if defined(_WIN32) || defined(_WIN64)
+    wakeEvent_ = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+#else
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+    stop();
+
+#if defined(_WIN32) || defined(_WIN64)
+    for (auto& subscription : active_) closeWatch(*subscription);
+    if (wakeEvent_) CloseHandle(wakeEvent_);
+#else
+    if (inotifyFd_ >= 0) close(inotifyFd_);
+    if (wakeFd_ >= 0) close(wakeFd_);
+#endif
+}
+
+void FileWatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    reconciledCv_.notify_all();
+    wake();
+    if (thread_.joinable()) thread_.join();
+}
+
+bool FileWatcher::isSupported() const {
+#if defined(_WIN32) || defined(_WIN64)
+    return wakeEvent_ != nullptr;
+#else
+    return inotifyFd_ >= 0 && wakeFd_ >= 0;
+#endif
+}
+
+FileWatcher::Stats FileWatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+FileWatcher::SubscriptionId FileWatcher::subscribe(const fs::path& root, bool recursive, Callback callback, Filter filter) {
+    if (!isSupported() || !callback) return 0;
+
+    auto subscription = std::make_shared<Subscription>();
+    subscription->root = root;
+    subscription->rootKey = keyOf(root);
+    subscription->recursive = recursive;
+    subscription->callback = std::move(callback);
+    subscription->filter = std::move(filter);
+
+    std::uint64_t request;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) return 0;
+        subscription->id = nextId_++;
+        subscriptions_[subscription->id] = subscription;
+        request = ++requested_;
+        // Started on first use so an unused watcher costs no thread.
+        if (!thread_.joinable()) thread_ = std::thread(&FileWatcher::run, this);
+    }
+
+    if (onWatcherThread()) {
+        reconcile();
+    } else {
+        wake();
+        std::unique_lock<std::mutex> lock(mutex_);
+        reconciledCv_.wait(lock, [&]() { return reconciled_ >= request || stop_; });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!subscription->armed) {
+        subscriptions_.erase(subscription->id);
+        return 0;
+    }
+    return subscription->id;
+}
+
+void FileWatcher::unsubscribe(SubscriptionId id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (subscriptions_.erase(id) == 0) return;
+        ++requested_;
+    }
+    wake();
+    // A batch taken before the erase may still be running; wait it out.
+    if (!onWatcherThread()) {
+        std::lock_guard<std::mutex> dispatching(dispatchMutex_);
+    }
+}
+
+void FileWatcher::run() {
+    while (true) {
+#if defined(_WIN32) || defined(_WIN64)
+        std::vector<HANDLE> handles{wakeEvent_};
+        std::vector<Subscription*> owners{nullptr};
+        for (auto& subscription : active_) {
+            if (!subscription->armed) continue;
+            handles.push_back(subscription->overlapped.hEvent);
+            owners.push_back(subscription.get());
+        }
+        DWORD timeout = pending_.empty() ? INFINITE : static_cast<DWORD>(timeUntilDue().count());
+        DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, timeout);
+        if (result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + handles.size()) {
+            readChanges(*owners[result - WAIT_OBJECT_0]);
+        }
+#else
+        pollfd fds[2] = {{inotifyFd_, POLLIN, 0}, {wakeFd_, POLLIN, 0}};
+        int timeout = pending_.empty() ? -1 : static_cast<int>(timeUntilDue().count());
+        int ready = poll(fds, 2, timeout);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready > 0 && (fds[1].revents & POLLIN)) {
+            std::uint64_t value;
+            while (read(wakeFd_, &value, sizeof(value)) > 0) {}
+        }
+        if (ready > 0 && (fds[0].revents & POLLIN)) readEvents();
+#endif
+        bool reconcileNeeded;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) break;
+            ++stats_.wakeups;
+            reconcileNeeded = reconciled_ != requested_;
+        }
+        if (reconcileNeeded) reconcile();
+        if (!pending_.empty() && timeUntilDue().count() <= 0) dispatch();
+    }
+}
+
+void FileWatcher::reconcile() {
+    std::vector<std::shared_ptr<Subscription>> wanted;
+    std::uint64_t request;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [id, subscription] : subscriptions_) wanted.push_back(subscription);
+        request = requested_;
+    }
+
+    auto isWanted = [&wanted](const std::shared_ptr<Subscription>& subscription) {
+        return std::find(wanted.begin(), wanted.end(), subscription) != wanted.end();
+    };
+#if defined(_WIN32) || defined(_WIN64)
+    for (auto& subscription : active_) {
+        if (!isWanted(subscription)) closeWatch(*subscription);
+    }
+    active_.erase(std::remove_if(active_.begin(), active_.end(), [&](const auto& s) { return !isWanted(s); }), active_.end());
+    for (auto& subscription : wanted) {
+        if (std::find(active_.begin(), active_.end(), subscription) != active_.end()) continue;
+        // WaitForMultipleObjects takes 64 handles, one of them is the wake event.
+        if (active_.size() < MAXIMUM_WAIT_OBJECTS - 1) armWatch(*subscription);
+        if (subscription->armed) active_.push_back(subscription);
+    }
+    std::uint64_t watches = active_.size();
+#else
+    active_.erase(std::remove_if(active_.begin(), active_.end(), [&](const auto& s) { return !isWanted(s); }), active_.end());
+    for (auto& subscription : wanted) {
+        if (std::find(active_.begin(), active_.end(), subscription) != active_.end()) continue;
+        active_.push_back(subscription);
+        if (subscription->recursive) {
+            addTree(subscription->root, false);
+            subscription->armed = watchIds_.count(subscription->rootKey) > 0;
+        } else {
+            subscription->armed = addWatch(subscription->root);
+        }
+        if (!subscription->armed) active_.pop_back();
+    }
+
+    // Drop watches no remaining subscription needs.
+    std::vector<std::string> unused;
+    for (const auto& [directory, wd] : watchIds_) {
+        if (!isCovered(directory)) unused.push_back(directory);
+    }
+    for (const auto& directory : unused) {
+        inotify_rm_watch(inotifyFd_, watchIds_[directory]);
+        watchPaths_.erase(watchIds_[directory]);
+        watchIds_.erase(directory);
+    }
+    std::uint64_t watches = watchIds_.size();
+#endif
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reconciled_ = (std::max)(reconciled_, request);
+        stats_.watches = watches;
+    }
+    reconciledCv_.notify_all();
+}
+
+void FileWatcher::record(const fs::path& path, std::uint32_t change, bool isDirectory) {
+    std::string key = keyOf(path);
+    auto now = std::chrono::steady_clock::now();
+    if (pending_.empty()) firstPending_ = now;
+    lastPending_ = now;
+
+    Pending& entry = pending_[key];
+    entry.isDirectory = isDirectory;
+    switch (change) {
+        case Created:
+            // Removed then created again within the window (e.g. a rename over it) is a modification.
+            entry.changes = (entry.changes & Removed) ? ((entry.changes & ~Removed) | Modified) : (entry.changes | Created);
+            break;
+        case Modified:
+            if (!(entry.changes & Created)) entry.changes |= Modified;
+            break;
+        case Removed:
+            // Created and gone again within the window (temporary files) is nothing.
+            if (entry.changes & Created) pending_.erase(key);
+            else entry.changes = Removed;
+            break;
+        default:
+            entry.changes |= change;
+            break;
+    }
+}
+
+void FileWatcher::recordOverflow(const fs::path& root) {
+    record(root, Overflow, true);
+}
+
+std::chrono::milliseconds FileWatcher::timeUntilDue() const {
+    auto due = (std::min)(lastPending_ + window_, firstPending_ + window_ * 4);
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+    return (std::max)(left, std::chrono::milliseconds(0));
+}
+
+void FileWatcher::dispatch() {
+    std::map<std::string, Pending> batch;
+    batch.swap(pending_);
+
+    std::lock_guard<std::mutex> dispatching(dispatchMutex_);
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [id, subscription] : subscriptions_) subscriptions.push_back(subscription);
+        ++stats_.batches;
+    }
+
+    for (const auto& subscription : subscriptions) {
+        const std::string& root = subscription->rootKey;
+        std::vector<Event> events;
+        for (const auto& [key, entry] : batch) {
+            if (entry.changes & Overflow) {
+                if (key == root) events.push_back({subscription->root, Overflow, true});
+                continue;
+            }
+            std::string parent = parentOf(key);
+            if (parent != root && !(subscription->recursive && isUnder(parent, root))) continue;
+            if (subscription->filter && !subscription->filter(fs::path(key.substr(root.size() + 1)))) continue;
+            events.push_back({fs::path(key), entry.changes, entry.isDirectory});
+        }
+        if (events.empty()) continue;
+        try {
+            subscription->callback(events);
+        } catch (...) {
+            // a throwing subscriber must not take the watcher down
+        }
+    }
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+void FileWatcher::wake() {
+    if (wakeEvent_) SetEvent(wakeEvent_);
+}
+
+void FileWatcher::armWatch(Subscription& subscription) {
+    subscription.directory = CreateFileW(subscription.root.c_str(), FILE_LIST_DIRECTORY,
+                                         FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                                         FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (subscription.directory == INVALID_HANDLE_VALUE) return;
+
+    subscription.overlapped = OVERLAPPED{};
+    subscription.overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    subscription.buffer.assign(64 * 1024 / sizeof(DWORD), 0);
+    if (!subscription.overlapped.hEvent) {
+        CloseHandle(subscription.directory);
+        subscription.directory = INVALID_HANDLE_VALUE;
+        return;
+    }
+
+    DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    subscription.armed = ReadDirectoryChangesW(subscription.directory, subscription.buffer.data(),
+                                               static_cast<DWORD>(subscription.buffer.size() * sizeof(DWORD)),
+                                               subscription.recursive, filter, nullptr, &subscription.overlapped, nullptr) != 0;
+    if (!subscription.armed) closeWatch(subscription);
+}
+
+void FileWatcher::closeWatch(Subscription& subscription) {
+    if (subscription.directory != INVALID_HANDLE_VALUE) {
+        if (subscription.armed) {
+            DWORD bytes = 0;
+            CancelIoEx(subscription.directory, &subscription.overlapped);
+            GetOverlappedResult(subscription.directory, &subscription.overlapped, &bytes, TRUE);
+        }
+        CloseHandle(subscription.directory);
+        subscription.directory = INVALID_HANDLE_VALUE;
+    }
+    if (subscription.overlapped.hEvent) {
+        CloseHandle(subscription.overlapped.hEvent);
+        subscription.overlapped.hEvent = nullptr;
+    }
+    subscription.armed = false;
+}
+
+void FileWatcher::readChanges(Subscription& subscription) {
+    DWORD bytes = 0;
+    BOOL ok = GetOverlappedResult(subscription.directory, &subscription.overlapped, &bytes, FALSE);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.rawEvents;
+    }
+
+    if (!ok || bytes == 0) {
+        // Zero bytes means the change buffer overflowed.
+        recordOverflow(subscription.root);
+    } else {
+        const char* cursor = reinterpret_cast<const char*>(subscription.buffer.data());
+        while (true) {
+            auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(cursor);
+            fs::path path = subscription.root / std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            std::error_code ec;
+            switch (info->Action) {
+                case FILE_ACTION_ADDED:
+                case FILE_ACTION_RENAMED_NEW_NAME:
+                    record(path, Created, fs::is_directory(path, ec));
+                    break;
+                case FILE_ACTION_REMOVED:
+                case FILE_ACTION_RENAMED_OLD_NAME:
+                    record(path, Removed, false);
+                    break;
+                case FILE_ACTION_MODIFIED:
+                    if (!fs::is_directory(path, ec)) record(path, Modified, false);
+                    break;
+            }
+            if (info->NextEntryOffset == 0) break;
+            cursor += info->NextEntryOffset;
+        }
+    }
+
+    ResetEvent(subscription.overlapped.hEvent);
+    DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    if (!ReadDirectoryChangesW(subscription.directory, subscription.buffer.data(),
+                               static_cast<DWORD>(subscription.buffer.size() * sizeof(DWORD)),
+                               subscription.recursive, filter, nullptr, &subscription.overlapped, nullptr)) {
+        // The directory is gone; its handle would stay signaled otherwise.
+        closeWatch(subscription);
+    }
+}
+
+#else
+
+namespace {
+constexpr std::uint32_t kWatchMask = IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                     IN_ONLYDIR | IN_EXCL_UNLINK;
+}
+
+void FileWatcher::wake() {
+    if (wakeFd_ < 0) return;
+    std::uint64_t one = 1;
+    ssize_t written = write(wakeFd_, &one, sizeof(one));
+    (void)written;
+}
+
+bool FileWatcher::addWatch(const fs::path& directory) {
+    std::string key = keyOf(directory);
+    int wd = inotify_add_watch(inotifyFd_, key.c_str(), kWatchMask);
+    if (wd < 0) return false;
+    watchPaths_[wd] = key;
+    watchIds_[key] = wd;
+    return true;
+}
+
+void FileWatcher::addTree(const fs::path& directory, bool reportContents) {
+    if (!addWatch(directory)) return;
+    // Watch first, then list: whatever appeared before the watch is picked up by the listing,
+    // and whatever appears after it by the watch. Duplicates coalesce.
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(directory, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        bool isDirectory = it->is_directory(ec) && !it->is_symlink(ec);
+        if (isDirectory) addWatch(it->path());
+        if (reportContents) record(it->path(), Created, isDirectory);
+    }
+}
+
+void FileWatcher::removeWatchesUnder(const std::string& directory) {
+    for (auto it = watchIds_.begin(); it != watchIds_.end();) {
+        if (it->first == directory || isUnder(it->first, directory)) {
+            inotify_rm_watch(inotifyFd_, it->second);
+            watchPaths_.erase(it->second);
+            it = watchIds_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool FileWatcher::isCovered(const std::string& directory) const {
+    for (const auto& subscription : active_) {
+        if (directory == subscription->rootKey) return true;
+        if (subscription->recursive && isUnder(directory, subscription->rootKey)) return true;
+    }
+    return false;
+}
+
+void FileWatcher::readEvents() {
+    alignas(inotify_event) char buffer[64 * 1024];
+    std::uint64_t count = 0;
+    while (true) {
+        ssize_t length = read(inotifyFd_, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* cursor = buffer; cursor < buffer + length;) {
+            auto event = reinterpret_cast<const inotify_event*>(cursor);
+            cursor += sizeof(inotify_event) + event->len;
+            ++count;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                for (const auto& subscription : active_) recordOverflow(subscription->root);
+                continue;
+            }
+            auto watch = watchPaths_.find(event->wd);
+            if (watch == watchPaths_.end()) continue;
+            if (event->mask & IN_IGNORED) {
+                // The directory was deleted or moved out of reach.
+                auto id = watchIds_.find(watch->second);
+                if (id != watchIds_.end() && id->second == event->wd) watchIds_.erase(id);
+                watchPaths_.erase(watch);
+                continue;
+            }
+            if (event->len == 0) continue;
+
+            std::string path = watch->second + "/" + event->name;
+            bool isDirectory = (event->mask & IN_ISDIR) != 0;
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                record(path, Created, isDirectory);
+                if (isDirectory && isCovered(path)) addTree(path, true);
+            } else if (event->mask & IN_CLOSE_WRITE) {
+                record(path, Modified, false);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                record(path, Removed, isDirectory);
+                // A moved directory keeps its watches under the old name; the move target re-adds them.
+                if (isDirectory && (event->mask & IN_MOVED_FROM)) removeWatchesUnder(path);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.rawEvents += count;
+}
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Event driven change notification (inotify on Linux, ReadDirectoryChangesW on Windows).
+// One thread blocks in the kernel until something changes, collects events for a short
+// coalescing window and hands each subscriber one batch with at most one event per path.
+// Nothing runs while the watched trees are quiet.
+//
+// On Linux only completed writes are reported (close after write, create, delete, rename), so a
+// file that is held open and appended to, like the active log, stays silent until it is closed.
+// Windows has no close-after-write notification and reports every write as Modified.
+class FileWatcher {
+public:
+    enum Change : std::uint32_t {
+        Created  = 1 << 0,
+        Modified = 1 << 1,
+        Removed  = 1 << 2,
+        // The kernel queue overflowed and events were lost; path is the subscription root, rescan it.
+        Overflow = 1 << 3
+    };
+
+    struct Event {
+        fs::path path;
+        std::uint32_t changes = 0;
+        bool isDirectory = false;
+    };
+
+    // Gets the path relative to the subscription root.
+    using Filter = std::function<bool(const fs::path& relative)>;
+    // Runs on the watcher thread.
+    using Callback = std::function<void(const std::vector<Event>& events)>;
+    using SubscriptionId = std::uint64_t;
+
+    struct Stats {
+        std::uint64_t wakeups = 0;
+        std::uint64_t rawEvents = 0;
+        std::uint64_t batches = 0;
+        std::uint64_t watches = 0;
+    };
+
+    // A burst is delivered once nothing new arrived for coalesceWindow, or 4 windows after it began.
+    explicit FileWatcher(std::chrono::milliseconds coalesceWindow = std::chrono::milliseconds(100));
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Watches root (and everything below it when recursive). Returns 0 if root can't be watched.
+    // Changes made after subscribe returns are reported.
+    SubscriptionId subscribe(const fs::path& root, bool recursive, Callback callback, Filter filter = nullptr);
+    // No callback of this subscription runs once it returns (unless called from that callback).
+    void unsubscribe(SubscriptionId id);
+
+    // Joins the watcher thread: no callback runs once it returns and later subscribes fail.
+    // Not from a callback. The destructor calls it.
+    void stop();
+
+    bool isSupported() const;
+    Stats getStats() const;
+
+private:
+    struct Subscription;
+    struct Pending {
+        std::uint32_t changes = 0;
+        bool isDirectory = false;
+    };
+
+    void run();
+    // Watcher thread: applies subscribe/unsubscribe requests.
+    void reconcile();
+    void record(const fs::path& path, std::uint32_t change, bool isDirectory);
+    void recordOverflow(const fs::path& root);
+    void dispatch();
+    std::chrono::milliseconds timeUntilDue() const;
+    void wake();
+    bool onWatcherThread() const { return std::this_thread::get_id() == thread_.get_id(); }
+
+    const std::chrono::milliseconds window_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable reconciledCv_;
+    std::map<SubscriptionId, std::shared_ptr<Subscription>> subscriptions_;
+    SubscriptionId nextId_ = 1;
+    std::uint64_t requested_ = 0;
+    std::uint64_t reconciled_ = 0;
+    bool stop_ = false;
+    Stats stats_;
+
+    // Held while callbacks run so unsubscribe can wait for an in-flight batch.
+    std::mutex dispatchMutex_;
+
+    // Watcher thread only
+    std::map<std::string, Pending> pending_;
+    std::vector<std::shared_ptr<Subscription>> active_;
+    std::chrono::steady_clock::time_point firstPending_;
+    std::chrono::steady_clock::time_point lastPending_;
+
+#if defined(_WIN32) || defined(_WIN64)
+    void armWatch(Subscription& subscription);
+    void closeWatch(Subscription& subscription);
+    void readChanges(Subscription& subscription);
+
+    void* wakeEvent_ = nullptr;
+#else
+    bool addWatch(const fs::path& directory);
+    void addTree(const fs::path& directory, bool reportContents);
+    void removeWatchesUnder(const std::string& directory);
+    bool isCovered(const std::string& directory) const;
+    void readEvents();
+
+    int inotifyFd_ = -1;
+    int wakeFd_ = -1;
+    std::unordered_map<int, std::string> watchPaths_; // watch descriptor -> directory
+    std::unordered_map<std::string, int> watchIds_;
+#endif
+
+    std::thread thread_;
+};
+
+#endif // FILE_WATCHER_HPP
@@ -0,0 +1,237 @@
+// Log_Compressor.cpp
+#include "Log_Compressor.hpp"
+#include "Log_Index.hpp"
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <zlib.h>
+
+LogCompressor::LogCompressor(int level) : level_(level) {}
+
+LogCompressor::~LogCompressor() {
+    stop();
+}
+
+void LogCompressor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void LogCompressor::setLevel(int level) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    level_ = std::clamp(level, 1, 9);
+}
+
+void LogCompressor::setCompressionEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    compress_ = enabled;
+}
+
+bool LogCompressor::isCompressionEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return compress_;
+}
+
+void LogCompressor::setCompletionCallback(CompletionCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+}
+
+void LogCompressor::enqueue(const fs::path& file) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_ || std::find(queue_.begin(), queue_.end(), file) != queue_.end()) return;
+        queue_.push_back(file);
+        // Started on first use so a FileSystem that never rotates costs no thread.
+        if (!thread_.joinable()) thread_ = std::thread(&LogCompressor::worker, this);
+    }
+    cv_.notify_one();
+}
+
+void LogCompressor::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCv_.wait(lock, [this]() { return (queue_.empty() && !busy_) || stop_; });
+}
+
+LogCompressor::Stats LogCompressor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void LogCompressor::worker() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (stop_) break;
+
+        fs::path source = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+        int level = level_;
+        bool compress = compress_;
+        lock.unlock();
+
+        std::uint64_t bytesIn = 0, bytesOut = 0;
+        std::string error;
+        fs::path output = source;
+        bool ok;
+        if (compress) {
+            output += kExtension;
+            ok = compressFile(source, output, level, &bytesIn, &bytesOut, &error);
+            if (ok) {
+                std::error_code ec;
+                fs::remove(source, ec);
+                fs::remove(LogIndex::pathFor(source), ec);
+            }
+        } else {
+            output = LogIndex::pathFor(source);
+            ok = indexFile(source, &bytesIn, &error);
+        }
+
+        lock.lock();
+        if (!ok) {
+            ++stats_.failures;
+        } else if (compress) {
+            ++stats_.files;
+            stats_.bytesIn += bytesIn;
+            stats_.bytesOut += bytesOut;
+        } else {
+            ++stats_.indexed;
+        }
+        CompletionCallback callback = callback_;
+        busy_ = false;
+        lock.unlock();
+        if (callback) callback(source, output, ok, bytesIn, bytesOut, error);
+        lock.lock();
+        if (queue_.empty()) idleCv_.notify_all();
+    }
+    busy_ = false;
+    idleCv_.notify_all();
+}
+
+bool LogCompressor::compressFile(const fs::path& source, const fs::path& target, int level,
+                                 std::uint64_t* bytesIn, std::uint64_t* bytesOut, std::string* error) {
+    auto fail = [error](const std::string& why) {
+        if (error) *error = why;
+        return false;
+    };
+
+    std::ifstream in(source, std::ios::binary);
+    if (!in) return fail("cannot open " + source.string());
+
+    fs::path partial = target;
+    partial += ".partial";
+    std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+    if (!out) return fail("cannot create " + partial.string());
+
+    z_stream stream{};
+    // 15 window bits plus 16 selects the gzip wrapper.
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return fail("deflateInit2 failed");
+    }
+
+    std::unique_ptr<char[]> inBuffer(new char[kBufferSize]);
+    std::unique_ptr<unsigned char[]> outBuffer(new unsigned char[kBufferSize]);
+    std::uint64_t totalIn = 0, totalOut = 0;
+    bool ok = true;
+
+    auto compress = [&](std::string_view data, int flush) {
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        do {
+            stream.next_out = outBuffer.get();
+            stream.avail_out = static_cast<uInt>(kBufferSize);
+            if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+                ok = fail("deflate failed");
+                return;
+            }
+            size_t produced = kBufferSize - stream.avail_out;
+            out.write(reinterpret_cast<const char*>(outBuffer.get()), static_cast<std::streamsize>(produced));
+            totalOut += produced;
+            if (!out) {
+                ok = fail("write failed on " + partial.string());
+                return;
+            }
+        } while (stream.avail_out == 0);
+    };
+
+    // A full flush after every block resets the dictionary, so each block inflates on its own.
+    LogIndex::Builder builder(LogIndex::formatOf(source), [&](std::string_view data, LogIndex::Block& block) {
+        if (!ok) return;
+        std::uint64_t start = totalOut;
+        compress(data, Z_FULL_FLUSH);
+        block.compressedOffset = start;
+        block.compressedLength = totalOut - start;
+        if (start == 0) {
+            // The first block's output opens with the gzip header, raw inflate starts after it.
+            constexpr std::uint64_t kGzipHeader = 10;
+            block.compressedOffset = kGzipHeader;
+            block.compressedLength -= kGzipHeader;
+        }
+    });
+
+    while (ok && in) {
+        in.read(inBuffer.get(), kBufferSize);
+        std::streamsize got = in.gcount();
+        if (in.bad()) {
+            ok = fail("read failed on " + source.string());
+            break;
+        }
+        if (got <= 0) break;
+        totalIn += static_cast<std::uint64_t>(got);
+        builder.feed(std::string_view(inBuffer.get(), static_cast<size_t>(got)));
+    }
+    LogIndex index = builder.finish();
+    if (ok) compress(std::string_view(), Z_FINISH);
+    deflateEnd(&stream);
+    out.close();
+
+    std::error_code ec;
+    if (ok && !out) ok = fail("write failed on " + partial.string());
+    if (ok) {
+        auto mtime = fs::last_write_time(source, ec);
+        if (!ec) fs::last_write_time(partial, mtime, ec);
+        fs::rename(partial, target, ec);
+        if (ec) ok = fail("rename failed: " + ec.message());
+    }
+    if (!ok) {
+        fs::remove(partial, ec);
+        return false;
+    }
+
+    // The archive is complete either way; without an index it's only slower to query.
+    index.compressed = true;
+    index.segmentSize = totalOut;
+    if (!index.save(LogIndex::pathFor(target))) fail("cannot write index for " + target.string());
+
+    if (bytesIn) *bytesIn = totalIn;
+    if (bytesOut) *bytesOut = totalOut;
+    return true;
+}
+
+bool LogCompressor::indexFile(const fs::path& segment, std::uint64_t* bytesIn, std::string* error) {
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(segment, ec);
+    if (ec) {
+        if (error) *error = "cannot stat " + segment.string();
+        return false;
+    }
+
+    LogIndex::Builder builder(LogIndex::formatOf(segment), nullptr);
+    bool read = LogIndex::readSegment(segment, [&builder](std::string_view chunk) {
+        builder.feed(chunk);
+        return true;
+    });
+    LogIndex index = builder.finish();
+    index.segmentSize = size;
+    if (!read || !index.save(LogIndex::pathFor(segment))) {
+        if (error) *error = "cannot index " + segment.string();
+        return false;
+    }
+    if (bytesIn) *bytesIn = size;
+    return true;
+}
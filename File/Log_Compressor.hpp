@@ -0,0 +1,81 @@
+#ifndef LOG_COMPRESSOR_HPP
+#define LOG_COMPRESSOR_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// Gzip-compresses rotated log files in process, on one worker thread that only runs while
+// there is work. Each file is streamed through zlib with fixed size buffers, written to
+// <file>.gz.partial and renamed to <file>.gz before the original is removed, so a crash
+// leaves either the original or the finished archive. Every archive gets a LogIndex sidecar;
+// with compression off the worker only writes the index next to the original.
+class LogCompressor {
+public:
+    struct Stats {
+        std::uint64_t files = 0;
+        std::uint64_t failures = 0;
+        std::uint64_t bytesIn = 0;
+        std::uint64_t bytesOut = 0;
+        std::uint64_t indexed = 0; // left uncompressed, index only
+    };
+
+    // Called on the worker thread after each file; output is the archive, or the index alone.
+    using CompletionCallback = std::function<void(const fs::path& source, const fs::path& output, bool ok,
+                                                  std::uint64_t bytesIn, std::uint64_t bytesOut, const std::string& error)>;
+
+    static constexpr const char* kExtension = ".gz";
+    static constexpr size_t kBufferSize = 64 * 1024;
+
+    explicit LogCompressor(int level = 6);
+    // Finishes the file in progress; anything still queued is left uncompressed.
+    ~LogCompressor();
+    // Same as the destructor: no completion callback runs once it returns, later files are ignored.
+    void stop();
+
+    LogCompressor(const LogCompressor&) = delete;
+    LogCompressor& operator=(const LogCompressor&) = delete;
+
+    void setLevel(int level);
+    // Applies to files the worker picks up from now on.
+    void setCompressionEnabled(bool enabled);
+    bool isCompressionEnabled() const;
+    void setCompletionCallback(CompletionCallback callback);
+
+    // Queues a closed file. Files already queued are ignored.
+    void enqueue(const fs::path& file);
+    // Blocks until the queue is empty and the worker is idle.
+    void waitIdle();
+    Stats getStats() const;
+
+    // Streams source into a gzip file at target, with a full flush at every index block, and
+    // writes the target's index. Keeps the source's modification time.
+    static bool compressFile(const fs::path& source, const fs::path& target, int level,
+                             std::uint64_t* bytesIn = nullptr, std::uint64_t* bytesOut = nullptr, std::string* error = nullptr);
+    // Writes the index of an uncompressed segment.
+    static bool indexFile(const fs::path& segment, std::uint64_t* bytesIn = nullptr, std::string* error = nullptr);
+
+private:
+    void worker();
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable idleCv_;
+    std::deque<fs::path> queue_;
+    std::thread thread_;
+    bool busy_ = false;
+    bool stop_ = false;
+    int level_;
+    bool compress_ = true;
+    CompletionCallback callback_;
+    Stats stats_;
+};
+
+#endif // LOG_COMPRESSOR_HPP
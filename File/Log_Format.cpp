@@ -0,0 +1,284 @@
+// Log_Format.cpp
+#include "Log_Format.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+std::array<std::atomic<const char*>, LogFormatRegistry::kMaxFormats> LogFormatRegistry::formats_{};
+std::atomic<std::uint32_t> LogFormatRegistry::count_{0};
+
+std::uint32_t LogFormatRegistry::registerFormat(const char* format) {
+    std::uint32_t id = count_.fetch_add(1, std::memory_order_relaxed);
+    if (id >= kMaxFormats) return kInvalidId;
+    formats_[id].store(format, std::memory_order_release);
+    return id;
+}
+
+const char* LogFormatRegistry::lookup(std::uint32_t id) {
+    if (id >= kMaxFormats) return nullptr;
+    return formats_[id].load(std::memory_order_acquire);
+}
+
+std::uint32_t LogFormatRegistry::size() {
+    return std::min(count_.load(std::memory_order_acquire), kMaxFormats);
+}
+
+namespace log_format {
+
+namespace {
+
+template<typename T>
+bool readRaw(std::string_view& data, T& value) {
+    if (data.size() < sizeof(T)) return false;
+    std::memcpy(&value, data.data(), sizeof(T));
+    data.remove_prefix(sizeof(T));
+    return true;
+}
+
+// Renders the next argument, false when the payload is exhausted or malformed.
+bool nextArg(std::string_view& args, std::string& out) {
+    if (args.empty()) return false;
+    char tag = args.front();
+    args.remove_prefix(1);
+    switch (tag) {
+        case Tag_Bool:
+            if (args.empty()) return false;
+            out += args.front() ? "true" : "false";
+            args.remove_prefix(1);
+            return true;
+        case Tag_Int: {
+            std::int64_t value;
+            if (!readRaw(args, value)) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case Tag_Uint: {
+            std::uint64_t value;
+            if (!readRaw(args, value)) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case Tag_Double: {
+            double value;
+            if (!readRaw(args, value)) return false;
+            char buffer[32];
+            int length = std::snprintf(buffer, sizeof(buffer), "%g", value);
+            out.append(buffer, static_cast<size_t>(length));
+            return true;
+        }
+        case Tag_String: {
+            std::uint32_t length;
+            if (!readRaw(args, length) || args.size() < length) return false;
+            out.append(args.substr(0, length));
+            args.remove_prefix(length);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::string formatMessage(const char* format, std::string_view args) {
+    std::string out;
+    std::string_view pattern = format ? format : "";
+    out.reserve(pattern.size() + args.size());
+
+    size_t start = 0;
+    for (size_t brace = pattern.find("{}"); brace != std::string_view::npos; brace = pattern.find("{}", start)) {
+        out.append(pattern.substr(start, brace - start));
+        if (!nextArg(args, out)) out += "{}";
+        start = brace + 2;
+    }
+    out.append(pattern.substr(start));
+
+    // Arguments without a placeholder are kept rather than silently lost.
+    std::string extra;
+    while (nextArg(args, extra)) {
+        out += ' ';
+        out += extra;
+        extra.clear();
+    }
+    return out;
+}
+
+std::string formatMessage(std::string_view payload) {
+    std::uint32_t id = LogFormatRegistry::kInvalidId;
+    if (!readRaw(payload, id)) return "<malformed log record>";
+    const char* format = LogFormatRegistry::lookup(id);
+    if (!format) return "<unknown log format " + std::to_string(id) + ">";
+    return formatMessage(format, payload);
+}
+
+} // namespace log_format
+
+std::string_view LogLineFormatter::timestamp(std::int64_t ticks) {
+    std::chrono::system_clock::time_point time{std::chrono::system_clock::duration(ticks)};
+    std::time_t t = std::chrono::system_clock::to_time_t(time);
+    if (t == cachedSecond_) return cachedTimestamp_;
+
+    std::tm tm{};
+#if defined(_WIN32) || defined(_WIN64)
+    localtime_s(&tm, &t);
+#else
+    localtime_r(&t, &tm);
+#endif
+    std::ostringstream ss;
+    ss << std::put_time(&tm, "%Y%m%d_%H%M%S");
+    cachedSecond_ = t;
+    cachedTimestamp_ = ss.str();
+    return cachedTimestamp_;
+}
+
+std::string LogLineFormatter::jsonLine(std::int64_t ticks, std::string_view level, std::string_view message) {
+    return toJson(timestamp(ticks), level, message);
+}
+
+std::string LogLineFormatter::toJson(std::string_view timestamp, std::string_view level, std::string_view message) {
+    std::string json;
+    json.reserve(48 + timestamp.size() + level.size() + message.size());
+    json += "{\"timestamp\":\"";
+    json += timestamp;
+    json += "\",\"level\":\"";
+    json += level;
+    json += "\",\"message\":\"";
+    json += message;
+    json += "\"}";
+    return json;
+}
+
+// Same numbering as FileSystem::LogLevel.
+const char* LogLineFormatter::levelName(std::uint8_t level) {
+    switch (level) {
+        case 0: return "INFO";
+        case 1: return "WARN";
+        case 2: return "ERROR";
+        case 3: return "DEBUG";
+        case 4: return "TRACE";
+    }
+    return "UNKNOWN";
+}
+
+std::string LogBinaryFormat::header() {
+    using Period = std::chrono::system_clock::period;
+    std::string out(kMagic, sizeof(kMagic));
+    log_format::appendRaw(out, kVersion);
+    log_format::appendRaw(out, std::uint16_t{0});
+    log_format::appendRaw(out, static_cast<std::int64_t>(Period::num));
+    log_format::appendRaw(out, static_cast<std::int64_t>(Period::den));
+    return out;
+}
+
+void LogBinaryFormat::encodeMessage(std::string& out, std::uint8_t level, std::int64_t ticks, std::string_view text) {
+    out.push_back('M');
+    out.push_back(static_cast<char>(level));
+    log_format::appendRaw(out, ticks);
+    log_format::appendRaw(out, static_cast<std::uint32_t>(text.size()));
+    out.append(text);
+}
+
+void LogBinaryFormat::encodeEntry(std::string& out, std::uint8_t level, std::int64_t ticks, std::string_view payload) {
+    std::uint32_t id = LogFormatRegistry::kInvalidId;
+    if (payload.size() >= sizeof(id)) std::memcpy(&id, payload.data(), sizeof(id));
+
+    const char* format = LogFormatRegistry::lookup(id);
+    if (!format) {
+        encodeMessage(out, level, ticks, log_format::formatMessage(payload));
+        return;
+    }
+    if (!defined_[id]) {
+        std::string_view text(format);
+        out.push_back('F');
+        log_format::appendRaw(out, id);
+        log_format::appendRaw(out, static_cast<std::uint32_t>(text.size()));
+        out.append(text);
+        defined_[id] = true;
+    }
+
+    out.push_back('E');
+    out.push_back(static_cast<char>(level));
+    log_format::appendRaw(out, ticks);
+    log_format::appendRaw(out, static_cast<std::uint32_t>(payload.size()));
+    out.append(payload);
+}
+
+bool LogBinaryFormat::isBinaryLog(std::string_view data) {
+    return data.size() >= kHeaderSize && std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+bool LogBinaryFormat::readHeader(std::string_view data, std::int64_t& periodNum, std::int64_t& periodDen) {
+    using log_format::readRaw;
+    if (!isBinaryLog(data)) return false;
+    std::uint16_t version = 0;
+    data.remove_prefix(sizeof(kMagic));
+    readRaw(data, version);
+    data.remove_prefix(sizeof(std::uint16_t));
+    readRaw(data, periodNum);
+    readRaw(data, periodDen);
+    return version == kVersion && periodNum > 0 && periodDen > 0;
+}
+
+long double LogBinaryFormat::tickScale(std::int64_t periodNum, std::int64_t periodDen) {
+    using Period = std::chrono::system_clock::period;
+    return static_cast<long double>(periodNum) * Period::den / (static_cast<long double>(periodDen) * Period::num);
+}
+
+bool LogBinaryFormat::messageOf(char type, std::string_view body, const std::vector<std::string>& formats, std::string& message) {
+    if (type == 'M') {
+        message.assign(body);
+        return true;
+    }
+    std::uint32_t id = LogFormatRegistry::kInvalidId;
+    if (type != 'E' || !log_format::readRaw(body, id) || id >= formats.size()) return false;
+    message = log_format::formatMessage(formats[id].c_str(), body);
+    return true;
+}
+
+bool LogBinaryFormat::decode(std::string_view data, const std::function<void(const std::string&)>& sink, std::string* error) {
+    using log_format::readRaw;
+    auto fail = [error](const char* why) {
+        if (error) *error = why;
+        return false;
+    };
+
+    std::int64_t num = 1, den = 1;
+    if (!isBinaryLog(data)) return fail("missing binary log header");
+    if (!readHeader(data, num, den)) return fail("unsupported binary log header");
+    data.remove_prefix(kHeaderSize);
+    long double scale = tickScale(num, den);
+
+    std::vector<std::string> formats;
+    LogLineFormatter formatter;
+    std::string message;
+    while (!data.empty()) {
+        char type = data.front();
+        data.remove_prefix(1);
+
+        if (type == 'F') {
+            std::uint32_t id = 0, length = 0;
+            if (!readRaw(data, id) || !readRaw(data, length) || data.size() < length) return fail("truncated format record");
+            if (id >= LogFormatRegistry::kMaxFormats) return fail("bad format id");
+            if (formats.size() <= id) formats.resize(id + 1);
+            formats[id].assign(data.substr(0, length));
+            data.remove_prefix(length);
+            continue;
+        }
+        if (type != 'M' && type != 'E') return fail("unknown record type");
+
+        std::uint8_t level = 0;
+        std::int64_t ticks = 0;
+        std::uint32_t length = 0;
+        if (!readRaw(data, level) || !readRaw(data, ticks) || !readRaw(data, length) || data.size() < length) {
+            return fail("truncated log record");
+        }
+        std::string_view body = data.substr(0, length);
+        data.remove_prefix(length);
+
+        if (!messageOf(type, body, formats, message)) return fail("log record uses an undefined format");
+        auto localTicks = static_cast<std::int64_t>(static_cast<long double>(ticks) * scale);
+        sink(formatter.jsonLine(localTicks, LogLineFormatter::levelName(level), message));
+    }
+    return true;
+}
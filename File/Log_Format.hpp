@@ -0,0 +1,145 @@
+#ifndef LOG_FORMAT_HPP
+#define LOG_FORMAT_HPP
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Deferred log formatting. A call site registers its format string once and from then on only
+// records the format id and its raw arguments; the writer thread (or the decoder, for binary
+// logs) substitutes the arguments into the "{}" placeholders.
+//
+//   fileSystem.logf(LOG_FORMAT_ID("Read file {} from folder {}"), LogLevel::Info, filename, folder);
+class LogFormatRegistry {
+public:
+    static constexpr std::uint32_t kMaxFormats = 4096;
+    static constexpr std::uint32_t kInvalidId = 0xFFFFFFFFu;
+
+    // The string must have static storage duration. Returns kInvalidId once the table is full.
+    static std::uint32_t registerFormat(const char* format);
+    static const char* lookup(std::uint32_t id);
+    // Ids handed out so far; lookup() can still be null for one being registered right now.
+    static std::uint32_t size();
+
+private:
+    static std::array<std::atomic<const char*>, kMaxFormats> formats_;
+    static std::atomic<std::uint32_t> count_;
+};
+
+// Registers the literal the first time this call site runs, afterwards it's a static load.
+#define LOG_FORMAT_ID(format) \
+    ([]() -> std::uint32_t { static const std::uint32_t id = LogFormatRegistry::registerFormat(format); return id; }())
+
+// Raw argument encoding: u32 format id, then per argument a type tag and its value.
+namespace log_format {
+
+enum ArgTag : char { Tag_Int = 'i', Tag_Uint = 'u', Tag_Double = 'd', Tag_Bool = 'b', Tag_String = 's' };
+
+template<typename T>
+inline void appendRaw(std::string& out, const T& value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+inline void encodeFormatId(std::string& out, std::uint32_t id) { appendRaw(out, id); }
+
+inline void encodeArg(std::string& out, bool value) {
+    out.push_back(Tag_Bool);
+    out.push_back(value ? 1 : 0);
+}
+
+template<std::signed_integral T>
+inline void encodeArg(std::string& out, T value) {
+    out.push_back(Tag_Int);
+    appendRaw(out, static_cast<std::int64_t>(value));
+}
+
+template<std::unsigned_integral T>
+inline void encodeArg(std::string& out, T value) {
+    out.push_back(Tag_Uint);
+    appendRaw(out, static_cast<std::uint64_t>(value));
+}
+
+template<std::floating_point T>
+inline void encodeArg(std::string& out, T value) {
+    out.push_back(Tag_Double);
+    appendRaw(out, static_cast<double>(value));
+}
+
+inline void encodeArg(std::string& out, std::string_view value) {
+    out.push_back(Tag_String);
+    appendRaw(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+}
+
+inline void encodeArg(std::string& out, const char* value) { encodeArg(out, std::string_view(value ? value : "")); }
+inline void encodeArg(std::string& out, const std::string& value) { encodeArg(out, std::string_view(value)); }
+
+// Substitutes the encoded arguments into the registered format. Unknown ids and
+// malformed payloads still produce a readable line rather than nothing.
+std::string formatMessage(std::string_view payload);
+std::string formatMessage(const char* format, std::string_view args);
+
+} // namespace log_format
+
+// Formats timestamps and JSON log lines exactly like FileSystem always has, caching the
+// formatted second. Shared by the writer thread and the binary log decoder.
+class LogLineFormatter {
+public:
+    // ticks are system_clock ticks since the epoch.
+    std::string_view timestamp(std::int64_t ticks);
+    std::string jsonLine(std::int64_t ticks, std::string_view level, std::string_view message);
+
+    static std::string toJson(std::string_view timestamp, std::string_view level, std::string_view message);
+    static const char* levelName(std::uint8_t level);
+
+private:
+    std::time_t cachedSecond_ = -1;
+    std::string cachedTimestamp_;
+};
+
+// Binary log file layout, little endian:
+//
+//   header:     "RLOG" | u16 version | u16 reserved | i64 tick period numerator | i64 denominator
+//   'F' record: u32 format id | u32 length | format string            (before the id's first use in a file)
+//   'M' record: u8 level | i64 ticks | u32 length | message text      (plain log() calls)
+//   'E' record: u8 level | i64 ticks | u32 length | u32 format id + raw arguments
+class LogBinaryFormat {
+public:
+    static constexpr char kMagic[4] = {'R', 'L', 'O', 'G'};
+    static constexpr std::uint16_t kVersion = 1;
+    static constexpr const char* kExtension = ".rlog";
+    static constexpr size_t kHeaderSize = 24;
+
+    // Writer side; definitions are emitted the first time an id shows up after reset().
+    static std::string header();
+    void reset() { defined_.assign(defined_.size(), false); }
+    void encodeMessage(std::string& out, std::uint8_t level, std::int64_t ticks, std::string_view text);
+    void encodeEntry(std::string& out, std::uint8_t level, std::int64_t ticks, std::string_view payload);
+
+    static bool isBinaryLog(std::string_view data);
+
+    // Header fields of a binary log, false if data doesn't start with one.
+    static bool readHeader(std::string_view data, std::int64_t& periodNum, std::int64_t& periodDen);
+    // Factor from the writer's tick period to ours (100 ns on Windows, 1 ns on Linux).
+    static long double tickScale(std::int64_t periodNum, std::int64_t periodDen);
+
+    // Message text of one 'M' or 'E' record body, formats indexed by id. False for an undefined format.
+    static bool messageOf(char type, std::string_view body, const std::vector<std::string>& formats, std::string& message);
+
+    // Turns a binary log back into the JSON lines the text mode would have written.
+    static bool decode(std::string_view data, const std::function<void(const std::string&)>& sink, std::string* error = nullptr);
+
+private:
+    std::vector<bool> defined_ = std::vector<bool>(LogFormatRegistry::kMaxFormats, false);
+};
+
+#endif // LOG_FORMAT_HPP
@@ -0,0 +1,520 @@
+// Log_Index.cpp
+#include "Log_Index.hpp"
+#include "Log_Format.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <zlib.h>
+
+namespace {
+
+using Format = LogIndex::Format;
+
+constexpr size_t kNoRecord = 0;
+constexpr size_t kCorrupt = std::numeric_limits<size_t>::max();
+constexpr std::uint32_t kUnknownLevel = 31;
+constexpr size_t kReadChunk = 64 * 1024;
+
+template<typename T>
+T readAt(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+// Length of the record at the start of data, kNoRecord if it isn't complete yet.
+size_t recordLength(Format format, std::string_view data) {
+    if (format == Format::Text) {
+        size_t newline = data.find('\n');
+        return newline == std::string_view::npos ? kNoRecord : newline + 1;
+    }
+    if (data.empty()) return kNoRecord;
+    switch (data.front()) {
+        case 'F':
+            if (data.size() < 9) return kNoRecord;
+            return 9 + static_cast<size_t>(readAt<std::uint32_t>(data.data() + 5));
+        case 'M':
+        case 'E':
+            if (data.size() < 14) return kNoRecord;
+            return 14 + static_cast<size_t>(readAt<std::uint32_t>(data.data() + 10));
+    }
+    return kCorrupt;
+}
+
+std::uint32_t levelBit(std::uint8_t level) {
+    return 1u << std::min<std::uint32_t>(level, kUnknownLevel);
+}
+
+void addFormat(std::vector<std::string>& table, std::string_view record) {
+    std::uint32_t id = readAt<std::uint32_t>(record.data() + 1);
+    if (id >= LogFormatRegistry::kMaxFormats) return;
+    if (table.size() <= id) table.resize(id + 1);
+    table[id].assign(record.substr(9));
+}
+
+// Format table as of some position in a segment. Definitions are applied in file order, so a
+// redefined id resolves to the string in effect where each record was written.
+struct FormatState {
+    std::vector<std::string> table;
+    size_t applied = 0; // bytes of the segment's 'F' records reflected in table
+
+    void add(std::string_view record) {
+        addFormat(table, record);
+        applied += record.size();
+    }
+    void catchUp(std::string_view formats, size_t upTo) {
+        while (applied < upTo && applied < formats.size()) {
+            std::string_view rest = formats.substr(applied);
+            size_t length = recordLength(Format::Binary, rest);
+            if (length == kNoRecord || length == kCorrupt || length > rest.size()) {
+                applied = upTo;
+                break;
+            }
+            add(rest.substr(0, length));
+        }
+    }
+};
+
+bool outside(const LogIndex::Block& block, std::int64_t from, std::int64_t to, std::uint32_t levels) {
+    return block.count == 0 || !(block.levels & levels) || block.maxTicks < from || block.minTicks > to;
+}
+
+// Filters and formats the records of one block, false once the sink asked to stop.
+bool processBlock(Format format, std::string_view data, FormatState& formats, long double scale,
+                  std::int64_t from, std::int64_t to, std::uint32_t levels, const LogIndex::EntrySink& sink) {
+    LogLineFormatter formatter;
+    LogIndex::Entry entry;
+    std::string message;
+    while (!data.empty()) {
+        size_t length = recordLength(format, data);
+        if (length == kNoRecord || length == kCorrupt || length > data.size()) break;
+        std::string_view record = data.substr(0, length);
+        data.remove_prefix(length);
+
+        if (format == Format::Text) {
+            std::string_view line = record.substr(0, record.size() - 1);
+            if (!LogIndex::parseTextLine(line, entry.ticks, entry.level)) continue;
+            if (entry.ticks < from || entry.ticks > to || !(levelBit(entry.level) & levels)) continue;
+            entry.line.assign(line);
+        } else {
+            char type = record.front();
+            if (type == 'F') formats.add(record);
+            if (type != 'M' && type != 'E') continue;
+            entry.level = static_cast<std::uint8_t>(record[1]);
+            entry.ticks = static_cast<std::int64_t>(static_cast<long double>(readAt<std::int64_t>(record.data() + 2)) * scale);
+            if (entry.ticks < from || entry.ticks > to || !(levelBit(entry.level) & levels)) continue;
+            if (!LogBinaryFormat::messageOf(type, record.substr(14), formats.table, message)) continue;
+            entry.line = formatter.jsonLine(entry.ticks, LogLineFormatter::levelName(entry.level), message);
+        }
+        if (!sink(entry)) return false;
+    }
+    return true;
+}
+
+// Inflates one block written between two full flushes.
+bool inflateBlock(std::string_view compressed, size_t length, std::string& out) {
+    z_stream stream{};
+    if (inflateInit2(&stream, -15) != Z_OK) return false;
+    out.resize(length);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(length);
+    int result = inflate(&stream, Z_SYNC_FLUSH);
+    bool ok = (result == Z_OK || result == Z_STREAM_END || result == Z_BUF_ERROR) && stream.avail_out == 0;
+    inflateEnd(&stream);
+    return ok;
+}
+
+} // namespace
+
+fs::path LogIndex::pathFor(const fs::path& segment) {
+    fs::path path = segment;
+    path += kExtension;
+    return path;
+}
+
+LogIndex::Format LogIndex::formatOf(const fs::path& segment) {
+    fs::path name = isCompressed(segment) ? segment.stem() : segment.filename();
+    return name.extension() == LogBinaryFormat::kExtension ? Format::Binary : Format::Text;
+}
+
+bool LogIndex::isCompressed(const fs::path& segment) {
+    return segment.extension() == ".gz";
+}
+
+std::int64_t LogIndex::minTicks() const {
+    std::int64_t ticks = std::numeric_limits<std::int64_t>::max();
+    for (const auto& block : blocks) {
+        if (block.count > 0) ticks = std::min(ticks, block.minTicks);
+    }
+    return ticks;
+}
+
+std::int64_t LogIndex::maxTicks() const {
+    std::int64_t ticks = std::numeric_limits<std::int64_t>::min();
+    for (const auto& block : blocks) {
+        if (block.count > 0) ticks = std::max(ticks, block.maxTicks);
+    }
+    return ticks;
+}
+
+bool LogIndex::save(const fs::path& path) const {
+    std::string data(kMagic, sizeof(kMagic));
+    log_format::appendRaw(data, kVersion);
+    data.push_back(static_cast<char>(format));
+    data.push_back(compressed ? 1 : 0);
+    log_format::appendRaw(data, segmentSize);
+    log_format::appendRaw(data, periodNum);
+    log_format::appendRaw(data, periodDen);
+    log_format::appendRaw(data, static_cast<std::uint32_t>(blocks.size()));
+    log_format::appendRaw(data, static_cast<std::uint32_t>(formats.size()));
+    for (const auto& block : blocks) {
+        log_format::appendRaw(data, block.offset);
+        log_format::appendRaw(data, block.length);
+        log_format::appendRaw(data, block.compressedOffset);
+        log_format::appendRaw(data, block.compressedLength);
+        log_format::appendRaw(data, block.minTicks);
+        log_format::appendRaw(data, block.maxTicks);
+        log_format::appendRaw(data, block.count);
+        log_format::appendRaw(data, block.levels);
+        log_format::appendRaw(data, block.formatsOffset);
+    }
+    data += formats;
+
+    fs::path partial = path;
+    partial += ".partial";
+    {
+        std::ofstream out(partial, std::ios::binary | std::ios::trunc);
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) return false;
+    }
+    std::error_code ec;
+    fs::rename(partial, path, ec);
+    if (ec) fs::remove(partial, ec);
+    return !ec;
+}
+
+std::optional<LogIndex> LogIndex::loadFor(const fs::path& segment) {
+    constexpr size_t kHeader = 4 + 2 + 1 + 1 + 8 + 8 + 8 + 4 + 4;
+    constexpr size_t kBlock = 8 * 6 + 4 * 3;
+
+    std::error_code ec;
+    std::uintmax_t size = fs::file_size(segment, ec);
+    if (ec) return std::nullopt;
+
+    std::ifstream in(pathFor(segment), std::ios::binary);
+    if (!in) return std::nullopt;
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (data.size() < kHeader || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) return std::nullopt;
+
+    const char* p = data.data() + 4;
+    if (readAt<std::uint16_t>(p) != kVersion) return std::nullopt;
+    LogIndex index;
+    index.format = static_cast<Format>(p[2]);
+    index.compressed = p[3] != 0;
+    index.segmentSize = readAt<std::uint64_t>(p + 4);
+    index.periodNum = readAt<std::int64_t>(p + 12);
+    index.periodDen = readAt<std::int64_t>(p + 20);
+    std::uint32_t blockCount = readAt<std::uint32_t>(p + 28);
+    std::uint32_t formatsLength = readAt<std::uint32_t>(p + 32);
+    if (index.segmentSize != size || index.periodNum <= 0 || index.periodDen <= 0) return std::nullopt;
+    if (data.size() != kHeader + blockCount * kBlock + formatsLength) return std::nullopt;
+
+    p = data.data() + kHeader;
+    index.blocks.resize(blockCount);
+    for (auto& block : index.blocks) {
+        block.offset = readAt<std::uint64_t>(p);
+        block.length = readAt<std::uint64_t>(p + 8);
+        block.compressedOffset = readAt<std::uint64_t>(p + 16);
+        block.compressedLength = readAt<std::uint64_t>(p + 24);
+        block.minTicks = readAt<std::int64_t>(p + 32);
+        block.maxTicks = readAt<std::int64_t>(p + 40);
+        block.count = readAt<std::uint32_t>(p + 48);
+        block.levels = readAt<std::uint32_t>(p + 52);
+        block.formatsOffset = readAt<std::uint32_t>(p + 56);
+        if (block.formatsOffset > formatsLength) return std::nullopt;
+        p += kBlock;
+    }
+    index.formats.assign(p, formatsLength);
+    return index;
+}
+
+LogIndex::Builder::Builder(Format format, BlockSink sink)
+    : sink_(std::move(sink)), headerPending_(format == Format::Binary) {
+    index_.format = format;
+    block_.reserve(kBlockSize + 4096);
+}
+
+void LogIndex::Builder::feed(std::string_view data) {
+    carry_.append(data);
+    size_t position = 0;
+    while (position < carry_.size()) {
+        std::string_view rest(carry_.data() + position, carry_.size() - position);
+        if (corrupt_) {
+            // Nothing past a bad record can be framed; keep the bytes, untimed.
+            block_.append(rest);
+            position = carry_.size();
+            if (block_.size() >= kBlockSize) emitBlock();
+            break;
+        }
+        if (headerPending_) {
+            if (rest.size() < LogBinaryFormat::kHeaderSize) break;
+            headerPending_ = false;
+            if (LogBinaryFormat::readHeader(rest, index_.periodNum, index_.periodDen)) {
+                scale_ = LogBinaryFormat::tickScale(index_.periodNum, index_.periodDen);
+            } else {
+                corrupt_ = true;
+            }
+            // The header is a block of its own, so every record block decodes without it.
+            block_.append(rest.substr(0, LogBinaryFormat::kHeaderSize));
+            emitBlock();
+            position += LogBinaryFormat::kHeaderSize;
+            continue;
+        }
+
+        size_t length = recordLength(index_.format, rest);
+        if (length == kNoRecord || length > rest.size()) break;
+        if (length == kCorrupt) {
+            corrupt_ = true;
+            continue;
+        }
+        addRecord(rest.substr(0, length));
+        position += length;
+    }
+    carry_.erase(0, position);
+}
+
+void LogIndex::Builder::addRecord(std::string_view record) {
+    bool timed = false;
+    std::int64_t ticks = 0;
+    std::uint8_t level = 0;
+    if (index_.format == Format::Text) {
+        timed = parseTextLine(record.substr(0, record.size() - 1), ticks, level);
+    } else if (record.front() == 'F') {
+        index_.formats.append(record);
+    } else {
+        timed = true;
+        level = static_cast<std::uint8_t>(record[1]);
+        ticks = static_cast<std::int64_t>(static_cast<long double>(readAt<std::int64_t>(record.data() + 2)) * scale_);
+    }
+
+    if (timed) {
+        if (current_.count == 0) {
+            current_.minTicks = current_.maxTicks = ticks;
+        } else {
+            current_.minTicks = std::min(current_.minTicks, ticks);
+            current_.maxTicks = std::max(current_.maxTicks, ticks);
+        }
+        ++current_.count;
+        current_.levels |= levelBit(level);
+    }
+
+    block_.append(record);
+    if (block_.size() >= kBlockSize) emitBlock();
+}
+
+void LogIndex::Builder::emitBlock() {
+    current_.offset = offset_;
+    current_.length = block_.size();
+    if (sink_) sink_(block_, current_);
+    index_.blocks.push_back(current_);
+    offset_ += block_.size();
+    block_.clear();
+    current_ = Block{};
+    current_.formatsOffset = static_cast<std::uint32_t>(index_.formats.size());
+}
+
+LogIndex LogIndex::Builder::finish() {
+    if (!carry_.empty()) {
+        block_.append(carry_);
+        carry_.clear();
+    }
+    if (!block_.empty()) emitBlock();
+    return std::move(index_);
+}
+
+bool LogIndex::readSegment(const fs::path& segment, const std::function<bool(std::string_view)>& chunk) {
+    std::ifstream in(segment, std::ios::binary);
+    if (!in) return false;
+    std::unique_ptr<char[]> buffer(new char[kReadChunk]);
+
+    if (!isCompressed(segment)) {
+        while (in) {
+            in.read(buffer.get(), kReadChunk);
+            std::streamsize got = in.gcount();
+            if (got <= 0) break;
+            if (!chunk(std::string_view(buffer.get(), static_cast<size_t>(got)))) return true;
+        }
+        return !in.bad();
+    }
+
+    z_stream stream{};
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) return false;
+    std::unique_ptr<char[]> output(new char[kReadChunk]);
+    bool ok = true, more = true;
+    while (ok && more && in) {
+        in.read(buffer.get(), kReadChunk);
+        std::streamsize got = in.gcount();
+        if (got <= 0) break;
+        stream.next_in = reinterpret_cast<Bytef*>(buffer.get());
+        stream.avail_in = static_cast<uInt>(got);
+        while (stream.avail_in > 0 && more) {
+            stream.next_out = reinterpret_cast<Bytef*>(output.get());
+            stream.avail_out = static_cast<uInt>(kReadChunk);
+            int result = inflate(&stream, Z_NO_FLUSH);
+            if (result != Z_OK && result != Z_STREAM_END) {
+                ok = false;
+                break;
+            }
+            size_t produced = kReadChunk - stream.avail_out;
+            if (produced > 0 && !chunk(std::string_view(output.get(), produced))) more = false;
+            // Concatenated gzip members are still one file.
+            if (result == Z_STREAM_END) inflateReset(&stream);
+        }
+    }
+    inflateEnd(&stream);
+    return ok;
+}
+
+bool LogIndex::querySegment(const fs::path& segment, std::int64_t from, std::int64_t to, std::uint32_t levels,
+                            const EntrySink& sink, QueryStats* stats) {
+    QueryStats ignored;
+    QueryStats& counters = stats ? *stats : ignored;
+    ++counters.segments;
+    Format format = formatOf(segment);
+
+    if (auto index = loadFor(segment)) {
+        if (index->blocks.empty() || index->maxTicks() < from || index->minTicks() > to) {
+            counters.blocksSkipped += index->blocks.size();
+            return true;
+        }
+
+        FormatState formats;
+        long double scale = LogBinaryFormat::tickScale(index->periodNum, index->periodDen);
+
+        std::ifstream in(segment, std::ios::binary);
+        if (!in) return true;
+        std::string raw, data;
+        for (const auto& block : index->blocks) {
+            if (outside(block, from, to, levels)) {
+                ++counters.blocksSkipped;
+                continue;
+            }
+            std::uint64_t offset = index->compressed ? block.compressedOffset : block.offset;
+            std::uint64_t length = index->compressed ? block.compressedLength : block.length;
+            raw.resize(length);
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(offset));
+            if (!in.read(raw.data(), static_cast<std::streamsize>(length))) continue;
+            ++counters.blocksRead;
+            counters.bytesRead += length;
+
+            if (index->compressed) {
+                if (!inflateBlock(raw, block.length, data)) continue;
+            } else {
+                data.swap(raw);
+            }
+            formats.catchUp(index->formats, block.formatsOffset);
+            if (!processBlock(format, data, formats, scale, from, to, levels, sink)) return false;
+        }
+        return true;
+    }
+
+    // No usable index: cut blocks on the fly and filter them the same way.
+    ++counters.segmentsScanned;
+    bool keepGoing = true;
+    FormatState formats;
+    std::unique_ptr<Builder> builder;
+    builder = std::make_unique<Builder>(format, [&](std::string_view data, Block& block) {
+        if (!keepGoing || outside(block, from, to, levels)) return;
+        formats.catchUp(builder->formats(), block.formatsOffset);
+        keepGoing = processBlock(format, data, formats, builder->tickScale(), from, to, levels, sink);
+    });
+    readSegment(segment, [&](std::string_view chunk) {
+        counters.bytesRead += chunk.size();
+        builder->feed(chunk);
+        return keepGoing;
+    });
+    if (keepGoing) builder->finish();
+    return keepGoing;
+}
+
+std::optional<std::int64_t> LogIndex::segmentStart(const fs::path& segment) {
+    if (auto index = loadFor(segment)) {
+        if (index->blocks.empty() || index->minTicks() == std::numeric_limits<std::int64_t>::max()) return std::nullopt;
+        return index->minTicks();
+    }
+
+    // Records are appended in time order, so the first timed record starts the segment.
+    std::optional<std::int64_t> start;
+    querySegment(segment, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(), ~0u,
+                 [&start](const Entry& entry) {
+                     start = entry.ticks;
+                     return false;
+                 });
+    return start;
+}
+
+bool LogIndex::parseTextLine(std::string_view line, std::int64_t& ticks, std::uint8_t& level) {
+    constexpr std::string_view kTimestamp = "{\"timestamp\":\"";
+    constexpr std::string_view kLevel = "\",\"level\":\"";
+    constexpr size_t kStampLength = 15; // YYYYMMDD_HHMMSS
+    if (line.size() < kTimestamp.size() + kStampLength + kLevel.size() || line.substr(0, kTimestamp.size()) != kTimestamp) {
+        return false;
+    }
+    std::string_view stamp = line.substr(kTimestamp.size(), kStampLength);
+    std::string_view rest = line.substr(kTimestamp.size() + kStampLength);
+    if (rest.substr(0, kLevel.size()) != kLevel) return false;
+    rest.remove_prefix(kLevel.size());
+    std::string_view name = rest.substr(0, rest.find('"'));
+
+    if (name == "INFO") level = 0;
+    else if (name == "WARN") level = 1;
+    else if (name == "ERROR") level = 2;
+    else if (name == "DEBUG") level = 3;
+    else if (name == "TRACE") level = 4;
+    else level = static_cast<std::uint8_t>(kUnknownLevel);
+
+    // Lines come in runs with the same second; mktime only runs when it changes.
+    thread_local char cachedStamp[kStampLength] = {};
+    thread_local std::int64_t cachedTicks = 0;
+    if (std::memcmp(cachedStamp, stamp.data(), kStampLength) == 0) {
+        ticks = cachedTicks;
+        return true;
+    }
+
+    int digits[14];
+    for (size_t i = 0, d = 0; i < kStampLength; ++i) {
+        if (i == 8) {
+            if (stamp[i] != '_') return false;
+            continue;
+        }
+        if (stamp[i] < '0' || stamp[i] > '9') return false;
+        digits[d++] = stamp[i] - '0';
+    }
+    auto number = [&digits](int first, int count) {
+        int value = 0;
+        for (int i = first; i < first + count; ++i) value = value * 10 + digits[i];
+        return value;
+    };
+
+    std::tm tm{};
+    tm.tm_year = number(0, 4) - 1900;
+    tm.tm_mon = number(4, 2) - 1;
+    tm.tm_mday = number(6, 2);
+    tm.tm_hour = number(8, 2);
+    tm.tm_min = number(10, 2);
+    tm.tm_sec = number(12, 2);
+    tm.tm_isdst = -1; // timestamps are local time
+    std::time_t seconds = std::mktime(&tm);
+    if (seconds == static_cast<std::time_t>(-1)) return false;
+
+    ticks = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(seconds)).count();
+    std::memcpy(cachedStamp, stamp.data(), kStampLength);
+    cachedTicks = ticks;
+    return true;
+}
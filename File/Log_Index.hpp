@@ -0,0 +1,130 @@
+#ifndef LOG_INDEX_HPP
+#define LOG_INDEX_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Sparse sidecar index (<segment>.idx) of a rotated log segment. The segment is cut into blocks
+// of about kBlockSize at record boundaries, and each block records its time range and the levels
+// it holds. Compressed segments are written with a zlib full flush at every block boundary, so a
+// block can be inflated on its own from its compressed offset. A query then reads only the
+// blocks that can match. Binary segments also keep their format definitions in the index, so
+// any block decodes without the ones before it. Ids are only unique within one writer run and
+// a later run appending to the same segment redefines them, so each block records how many
+// definition bytes precede it and a query replays exactly those.
+//
+// Times are system_clock ticks; text logs only carry whole seconds.
+class LogIndex {
+public:
+    enum class Format : std::uint8_t { Text, Binary };
+
+    struct Block {
+        std::uint64_t offset = 0;           // in the uncompressed segment
+        std::uint64_t length = 0;
+        std::uint64_t compressedOffset = 0; // only for compressed segments
+        std::uint64_t compressedLength = 0;
+        std::int64_t minTicks = 0;
+        std::int64_t maxTicks = 0;
+        std::uint32_t count = 0;            // timed records
+        std::uint32_t levels = 0;           // bit per FileSystem::LogLevel value
+        std::uint32_t formatsOffset = 0;    // binary segments: bytes of formats before the block
+    };
+
+    // One query match, as the JSON line the text log holds.
+    struct Entry {
+        std::int64_t ticks = 0;
+        std::uint8_t level = 0;
+        std::string line;
+    };
+    // Return false to stop the query.
+    using EntrySink = std::function<bool(const Entry& entry)>;
+
+    struct QueryStats {
+        std::uint64_t segments = 0;
+        std::uint64_t segmentsScanned = 0; // read in full for lack of an index
+        std::uint64_t blocksRead = 0;
+        std::uint64_t blocksSkipped = 0;
+        std::uint64_t bytesRead = 0;
+    };
+
+    static constexpr char kMagic[4] = {'R', 'I', 'D', 'X'};
+    static constexpr std::uint16_t kVersion = 2;
+    static constexpr const char* kExtension = ".idx";
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    Format format = Format::Text;
+    bool compressed = false;
+    std::uint64_t segmentSize = 0;  // of the file on disk, a mismatch means the index is stale
+    std::int64_t periodNum = 1;     // binary segments: tick period of the writer
+    std::int64_t periodDen = 1;
+    std::vector<Block> blocks;
+    std::string formats;            // binary segments: every 'F' record of the segment, in order
+
+    static fs::path pathFor(const fs::path& segment);
+    static Format formatOf(const fs::path& segment);
+    static bool isCompressed(const fs::path& segment);
+
+    bool save(const fs::path& path) const;
+    // Empty if missing, unreadable or not matching the segment's current size.
+    static std::optional<LogIndex> loadFor(const fs::path& segment);
+
+    std::int64_t minTicks() const;
+    std::int64_t maxTicks() const;
+
+    // Splits a segment's bytes into blocks as they stream in (see below).
+    class Builder;
+
+    // Streams the entries of one segment with from <= ticks <= to whose level bit is in levels.
+    // Uses the sidecar index when there is a valid one, otherwise scans the whole segment.
+    // Returns false once the sink asked to stop.
+    static bool querySegment(const fs::path& segment, std::int64_t from, std::int64_t to, std::uint32_t levels,
+                             const EntrySink& sink, QueryStats* stats = nullptr);
+
+    // Earliest record time of a segment, from its index or its first block.
+    static std::optional<std::int64_t> segmentStart(const fs::path& segment);
+
+    // Time and level of a JSON log line.
+    static bool parseTextLine(std::string_view line, std::int64_t& ticks, std::uint8_t& level);
+
+    // Runs chunk over the segment's uncompressed bytes; the chunk returns false to stop.
+    static bool readSegment(const fs::path& segment, const std::function<bool(std::string_view)>& chunk);
+};
+
+// Splits a segment's bytes into blocks as they stream in. The sink sees each block's data
+// once and may fill in its compressed offsets before the block is kept.
+class LogIndex::Builder {
+public:
+    using BlockSink = std::function<void(std::string_view data, Block& block)>;
+
+    Builder(Format format, BlockSink sink);
+    void feed(std::string_view data);
+    // Emits the last block; a torn record at the end goes in untimed.
+    LogIndex finish();
+
+    // 'F' records seen so far, in order (binary segments).
+    const std::string& formats() const { return index_.formats; }
+    long double tickScale() const { return scale_; }
+
+private:
+    void addRecord(std::string_view record);
+    void emitBlock();
+
+    LogIndex index_;
+    BlockSink sink_;
+    std::uint64_t offset_ = 0;
+    std::string carry_;
+    std::string block_;
+    Block current_;
+    bool headerPending_;
+    bool corrupt_ = false;
+    long double scale_ = 1.0L;
+};
+
+#endif // LOG_INDEX_HPP
@@ -0,0 +1,123 @@
+// Log_Modules.cpp
+#include "Log_Modules.hpp"
+#include <cctype>
+#include <cstdio>
+#include <string>
+
+std::atomic<LogSeverity> LogModules::levels_[static_cast<size_t>(LogModule::Count)] = {
+    LogSeverity::Info, LogSeverity::Info, LogSeverity::Info, LogSeverity::Info, LogSeverity::Info
+};
+std::atomic<FileSystem*> LogModules::target_{nullptr};
+
+namespace {
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+    return text;
+}
+
+bool parseSeverity(std::string_view text, LogSeverity& level) {
+    for (int i = 0; i <= static_cast<int>(LogSeverity::Off); ++i) {
+        auto candidate = static_cast<LogSeverity>(i);
+        if (equalsIgnoreCase(text, LogModules::severityName(candidate))) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+void LogModules::setLevel(LogModule module, LogSeverity level) {
+    if (module >= LogModule::Count) return;
+    levels_[static_cast<size_t>(module)].store(level, std::memory_order_relaxed);
+}
+
+void LogModules::setAllLevels(LogSeverity level) {
+    for (auto& moduleLevel : levels_) moduleLevel.store(level, std::memory_order_relaxed);
+}
+
+LogSeverity LogModules::getLevel(LogModule module) {
+    if (module >= LogModule::Count) return LogSeverity::Off;
+    return levels_[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+}
+
+bool LogModules::configure(std::string_view spec) {
+    bool ok = true;
+    while (!spec.empty()) {
+        size_t comma = spec.find(',');
+        std::string_view item = trim(spec.substr(0, comma));
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+        if (item.empty()) continue;
+
+        size_t equals = item.find('=');
+        std::string_view name = equals == std::string_view::npos ? std::string_view("*") : trim(item.substr(0, equals));
+        std::string_view value = equals == std::string_view::npos ? item : trim(item.substr(equals + 1));
+
+        LogSeverity level;
+        if (!parseSeverity(value, level)) {
+            ok = false;
+            continue;
+        }
+        if (name == "*") {
+            setAllLevels(level);
+            continue;
+        }
+
+        bool found = false;
+        for (size_t i = 0; i < static_cast<size_t>(LogModule::Count); ++i) {
+            if (equalsIgnoreCase(name, moduleName(static_cast<LogModule>(i)))) {
+                setLevel(static_cast<LogModule>(i), level);
+                found = true;
+            }
+        }
+        ok = ok && found;
+    }
+    return ok;
+}
+
+const char* LogModules::moduleName(LogModule module) {
+    switch (module) {
+        case LogModule::FileSystem: return "FileSystem";
+        case LogModule::FolderSystem: return "FolderSystem";
+        case LogModule::ConfigSystem: return "ConfigSystem";
+        case LogModule::FiberPool: return "FiberPool";
+        case LogModule::Commands: return "Commands";
+        case LogModule::Count: break;
+    }
+    return "Unknown";
+}
+
+const char* LogModules::severityName(LogSeverity level) {
+    switch (level) {
+        case LogSeverity::Trace: return "Trace";
+        case LogSeverity::Debug: return "Debug";
+        case LogSeverity::Info: return "Info";
+        case LogSeverity::Warn: return "Warn";
+        case LogSeverity::Error: return "Error";
+        case LogSeverity::Off: return "Off";
+    }
+    return "Unknown";
+}
+
+void LogModules::clearTarget(FileSystem* target) {
+    target_.compare_exchange_strong(target, nullptr, std::memory_order_acq_rel);
+}
+
+void LogModules::writeFallback(LogLevel level, std::string_view payload) {
+    std::string line = LogLineFormatter::levelName(static_cast<std::uint8_t>(level));
+    line += ' ';
+    line += log_format::formatMessage(payload);
+    line += '\n';
+    std::fwrite(line.data(), 1, line.size(), stderr);
+}
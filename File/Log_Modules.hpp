@@ -0,0 +1,116 @@
+#ifndef LOG_MODULES_HPP
+#define LOG_MODULES_HPP
+
+#include "File_System.hpp"
+#include "Log_Format.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+// Per-module log levels for the RLOG_* macros.
+//
+//   RLOG_DEBUG(FolderSystem, "Read file {} from folder {}", filename, folderName);
+//
+// A message below RLOG_COMPILE_LEVEL is discarded at compile time. Above it, the module's
+// runtime level is checked with one relaxed atomic load before any argument is evaluated, and
+// only then is the record handed to the target FileSystem through logf.
+enum class LogModule : std::uint8_t {
+    FileSystem,
+    FolderSystem,
+    ConfigSystem,
+    FiberPool,
+    Commands,
+    Count
+};
+
+// Ordering for thresholds; FileSystem::LogLevel keeps its stored values for old logs.
+enum class LogSeverity : std::uint8_t { Trace, Debug, Info, Warn, Error, Off };
+
+// Build-time threshold as a LogSeverity value, e.g. -DRLOG_COMPILE_LEVEL=2 keeps INFO and up.
+#ifndef RLOG_COMPILE_LEVEL
+#define RLOG_COMPILE_LEVEL 0
+#endif
+
+class LogModules {
+public:
+    using LogLevel = FileSystem::LogLevel;
+
+    static constexpr LogSeverity severity(LogLevel level) {
+        switch (level) {
+            case LogLevel::Trace: return LogSeverity::Trace;
+            case LogLevel::Debug: return LogSeverity::Debug;
+            case LogLevel::Info: return LogSeverity::Info;
+            case LogLevel::Warn: return LogSeverity::Warn;
+            case LogLevel::Error: return LogSeverity::Error;
+        }
+        return LogSeverity::Error;
+    }
+
+    static constexpr LogSeverity kCompileLevel = static_cast<LogSeverity>(RLOG_COMPILE_LEVEL);
+
+    static constexpr bool isCompiledIn(LogLevel level) { return severity(level) >= kCompileLevel; }
+
+    static bool isEnabled(LogModule module, LogLevel level) {
+        return severity(level) >= levels_[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+    }
+
+    // Every module starts at Info.
+    static void setLevel(LogModule module, LogSeverity level);
+    static void setAllLevels(LogSeverity level);
+    static LogSeverity getLevel(LogModule module);
+
+    // "Info", or a list like "*=Warn,FolderSystem=Trace"; names are case-insensitive.
+    // Returns false (having applied the valid parts) if something didn't parse.
+    static bool configure(std::string_view spec);
+
+    static const char* moduleName(LogModule module);
+    static const char* severityName(LogSeverity level);
+
+    // Where the macros log to. FileSystem clears it when the target is destroyed.
+    // Without a target, enabled messages are formatted and written to stderr.
+    static void setTarget(FileSystem* target) { target_.store(target, std::memory_order_release); }
+    static FileSystem* getTarget() { return target_.load(std::memory_order_acquire); }
+    static void clearTarget(FileSystem* target);
+
+    template<typename... Args>
+    static void write(FileSystem* target, LogLevel level, std::uint32_t formatId, const Args&... args);
+
+private:
+    static void writeFallback(LogLevel level, std::string_view payload);
+
+    static std::atomic<LogSeverity> levels_[static_cast<size_t>(LogModule::Count)];
+    static std::atomic<FileSystem*> target_;
+};
+
+template<typename... Args>
+void LogModules::write(FileSystem* target, LogLevel level, std::uint32_t formatId, const Args&... args) {
+    if (target) {
+        target->logf(formatId, level, args...);
+        return;
+    }
+    thread_local std::string payload;
+    payload.clear();
+    log_format::encodeFormatId(payload, formatId);
+    (log_format::encodeArg(payload, args), ...);
+    writeFallback(level, payload);
+}
+
+// The format is prefixed with "[Module] " at compile time. The target expression, like the
+// arguments, is only evaluated when the message is enabled.
+#define RLOG_TO(target, module, level, format, ...)                                                        \
+    do {                                                                                                  \
+        if constexpr (LogModules::isCompiledIn(FileSystem::LogLevel::level)) {                            \
+            if (LogModules::isEnabled(LogModule::module, FileSystem::LogLevel::level)) {                  \
+                LogModules::write((target), FileSystem::LogLevel::level,                                  \
+                                  LOG_FORMAT_ID("[" #module "] " format) __VA_OPT__(, ) __VA_ARGS__);     \
+            }                                                                                             \
+        }                                                                                                 \
+    } while (0)
+
+#define RLOG_TRACE(module, format, ...) RLOG_TO(LogModules::getTarget(), module, Trace, format __VA_OPT__(, ) __VA_ARGS__)
+#define RLOG_DEBUG(module, format, ...) RLOG_TO(LogModules::getTarget(), module, Debug, format __VA_OPT__(, ) __VA_ARGS__)
+#define RLOG_INFO(module, format, ...) RLOG_TO(LogModules::getTarget(), module, Info, format __VA_OPT__(, ) __VA_ARGS__)
+#define RLOG_WARN(module, format, ...) RLOG_TO(LogModules::getTarget(), module, Warn, format __VA_OPT__(, ) __VA_ARGS__)
+#define RLOG_ERROR(module, format, ...) RLOG_TO(LogModules::getTarget(), module, Error, format __VA_OPT__(, ) __VA_ARGS__)
+
+#endif // LOG_MODULES_HPP
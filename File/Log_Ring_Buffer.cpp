@@ -0,0 +1,335 @@
+// Log_Ring_Buffer.cpp
+#include "Log_Ring_Buffer.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <thread>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Ring file layout: this header, capacity slots, then kStringAreaSize bytes of
+// [u32 id][u32 length][bytes] string entries. Native byte order, it's read back on the same machine.
+struct LogRingBuffer::FileHeader {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t slotSize;
+    std::uint32_t capacity;
+    std::uint32_t reserved;
+    std::atomic<std::uint64_t> persisted;  // first position not yet in the log file
+    std::atomic<std::uint32_t> stringsLength;
+    char padding[kSlotSize - 28];
+};
+
+namespace {
+
+constexpr char kRingMagic[4] = {'R', 'R', 'N', 'G'};
+constexpr std::uint16_t kRingVersion = 1;
+
+} // namespace
+
+LogRingBuffer::LogRingBuffer(size_t slotCount) {
+    static_assert(sizeof(FileHeader) == kSlotSize, "ring file header must keep the slots aligned");
+    capacity_ = 1;
+    while (capacity_ < (std::max)(slotCount, kMaxSlotsPerRecord)) capacity_ <<= 1;
+    mask_ = capacity_ - 1;
+    heapSlots_ = std::make_unique<Slot[]>(capacity_);
+    slots_ = heapSlots_.get();
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+LogRingBuffer::~LogRingBuffer() {
+    unmapFile();
+}
+
+bool LogRingBuffer::tryClaim(size_t slots, std::uint64_t& position) {
+    std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    while (true) {
+        // The consumer frees slots in order, so the last one being free means all of them are.
+        std::uint64_t last = tail + slots - 1;
+        std::uint64_t sequence = slots_[last & mask_].sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(sequence - last);
+        if (diff < 0) return false; // still holds a record from the previous lap
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(tail, tail + slots, std::memory_order_relaxed)) {
+                position = tail;
+                return true;
+            }
+        } else {
+            tail = tail_.load(std::memory_order_relaxed); // another producer got there first
+        }
+    }
+}
+
+bool LogRingBuffer::push(std::uint8_t level, std::uint8_t kind, std::int64_t timestamp,
+                         std::string_view payload, bool canBlock) {
+    if (payload.size() > kMaxPayload) payload = payload.substr(0, kMaxPayload);
+    size_t count = payload.empty() ? 1 : (payload.size() + kPayloadPerSlot - 1) / kPayloadPerSlot;
+
+    std::uint64_t position = 0;
+    while (!tryClaim(count, position)) {
+        OverflowPolicy policy = getPolicy();
+        if (policy != OverflowPolicy::Block || !canBlock) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    // Continuation slots first, the head slot last: the consumer keys off the head.
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        Slot& slot = slots_[(position + i) & mask_];
+        size_t chunk = (std::min)(payload.size() - offset, kPayloadPerSlot);
+        std::memcpy(slot.payload, payload.data() + offset, chunk);
+        offset += chunk;
+        if (i > 0) slot.sequence.store(position + i + 1, std::memory_order_release);
+    }
+
+    Slot& head = slots_[position & mask_];
+    head.timestamp = timestamp;
+    head.length = static_cast<std::uint32_t>(payload.size());
+    head.slotCount = static_cast<std::uint16_t>(count);
+    head.level = level;
+    head.kind = kind;
+    head.sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogRingBuffer::empty() const {
+    const Slot& first = slots_[head_ & mask_];
+    return first.sequence.load(std::memory_order_acquire) != head_ + 1;
+}
+
+std::uint64_t LogRingBuffer::takeDroppedSinceReport() {
+    std::uint64_t total = dropped_.load(std::memory_order_relaxed);
+    std::uint64_t fresh = total - reportedDropped_;
+    reportedDropped_ = total;
+    return fresh;
+}
+
+bool LogRingBuffer::mapFile(const fs::path& path, std::vector<Record>* leftover, std::vector<std::string>* strings) {
+    size_t size = sizeof(FileHeader) + capacity_ * kSlotSize + kStringAreaSize;
+    // A ring file is at most a few MB; anything far bigger isn't one and isn't read.
+    constexpr std::uint64_t kMaxPrevious = 256ull * 1024 * 1024;
+    std::string previous;
+    char* base = nullptr;
+#if defined(_WIN32) || defined(_WIN64)
+    // No write sharing, so a second owner (another instance with the same data directory) fails here.
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER existing{};
+    if (GetFileSizeEx(file, &existing) && existing.QuadPart > 0 && static_cast<std::uint64_t>(existing.QuadPart) <= kMaxPrevious) {
+        previous.resize(static_cast<size_t>(existing.QuadPart));
+        DWORD got = 0;
+        if (!ReadFile(file, previous.data(), static_cast<DWORD>(previous.size()), &got, nullptr)) got = 0;
+        previous.resize(got);
+    }
+    LARGE_INTEGER fileSize{};
+    fileSize.QuadPart = static_cast<LONGLONG>(size);
+    HANDLE mapping = nullptr;
+    if (SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) && SetEndOfFile(file)) {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    }
+    if (mapping) base = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    // flock is per open file, so this also keeps out a second ring in the same process.
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        ::close(fd);
+        return false;
+    }
+    struct stat info{};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0 && static_cast<std::uint64_t>(info.st_size) <= kMaxPrevious) {
+        previous.resize(static_cast<size_t>(info.st_size));
+        ssize_t got = ::pread(fd, previous.data(), previous.size(), 0);
+        previous.resize(got > 0 ? static_cast<size_t>(got) : 0);
+    }
+    void* address = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (address == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    base = static_cast<char*>(address);
+#endif
+    readRingFile(previous, leftover, strings);
+
+    // Writing every page now also takes the page faults here rather than in push().
+    std::memset(base, 0, size);
+    auto* header = new (base) FileHeader();
+    auto* slots = reinterpret_cast<Slot*>(base + sizeof(FileHeader));
+    char* stringArea = base + sizeof(FileHeader) + capacity_ * kSlotSize;
+    if (!header_) released_ = head_;
+
+    // Carry over whatever is queued, positions and all.
+    for (size_t i = 0; i < capacity_; ++i) {
+        Slot* slot = new (&slots[i]) Slot();
+        slot->sequence.store(slots_[i].sequence.load(std::memory_order_acquire), std::memory_order_relaxed);
+        slot->timestamp = slots_[i].timestamp;
+        slot->length = slots_[i].length;
+        slot->slotCount = slots_[i].slotCount;
+        slot->level = slots_[i].level;
+        slot->kind = slots_[i].kind;
+        std::memcpy(slot->payload, slots_[i].payload, kPayloadPerSlot);
+    }
+    std::uint32_t stringsLength = 0;
+    if (header_) {
+        stringsLength = header_->stringsLength.load(std::memory_order_acquire);
+        std::memcpy(stringArea, strings_, stringsLength);
+    }
+
+    std::memcpy(header->magic, kRingMagic, sizeof(kRingMagic));
+    header->version = kRingVersion;
+    header->slotSize = static_cast<std::uint16_t>(kSlotSize);
+    header->capacity = static_cast<std::uint32_t>(capacity_);
+    header->stringsLength.store(stringsLength, std::memory_order_relaxed);
+    header->persisted.store(released_, std::memory_order_release);
+
+    unmapFile();
+    heapSlots_.reset();
+    slots_ = slots;
+    header_ = header;
+    strings_ = stringArea;
+    mapping_ = base;
+    mappingSize_ = size;
+#if defined(_WIN32) || defined(_WIN64)
+    fileHandle_ = file;
+    mappingHandle_ = mapping;
+#else
+    fd_ = fd;
+#endif
+    return true;
+}
+
+void LogRingBuffer::unmapFile() {
+    if (!mapping_) return;
+#if defined(_WIN32) || defined(_WIN64)
+    UnmapViewOfFile(mapping_);
+    CloseHandle(mappingHandle_);
+    CloseHandle(fileHandle_);
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+#else
+    ::munmap(mapping_, mappingSize_);
+    ::close(fd_);
+    fd_ = -1;
+#endif
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    header_ = nullptr;
+    strings_ = nullptr;
+}
+
+void LogRingBuffer::markPersisted() {
+    if (!header_ || released_ == head_) return;
+    // Position first: a crash between the two recovers records twice rather than losing them.
+    header_->persisted.store(head_, std::memory_order_release);
+    for (; released_ < head_; ++released_) {
+        slots_[released_ & mask_].sequence.store(released_ + capacity_, std::memory_order_release);
+    }
+}
+
+bool LogRingBuffer::addString(std::uint32_t id, std::string_view text) {
+    std::lock_guard<std::mutex> lock(stringsMutex_);
+    if (!header_) return false;
+    std::uint32_t length = header_->stringsLength.load(std::memory_order_relaxed);
+    std::uint32_t textLength = static_cast<std::uint32_t>(text.size());
+    if (kStringAreaSize - length < 2 * sizeof(std::uint32_t) + text.size()) return false;
+
+    char* entry = strings_ + length;
+    std::memcpy(entry, &id, sizeof(id));
+    std::memcpy(entry + 4, &textLength, sizeof(textLength));
+    std::memcpy(entry + 8, text.data(), text.size());
+    header_->stringsLength.store(length + 8 + textLength, std::memory_order_release);
+    return true;
+}
+
+bool LogRingBuffer::readRingFile(std::string_view data, std::vector<Record>* records, std::vector<std::string>* strings) {
+    auto read = [&data](size_t offset, auto& value) { std::memcpy(&value, data.data() + offset, sizeof(value)); };
+    if (data.size() < sizeof(FileHeader)) return false;
+
+    std::uint16_t version = 0, slotSize = 0;
+    std::uint32_t capacity = 0, stringsLength = 0;
+    std::uint64_t position = 0;
+    read(offsetof(FileHeader, version), version);
+    read(offsetof(FileHeader, slotSize), slotSize);
+    read(offsetof(FileHeader, capacity), capacity);
+    read(offsetof(FileHeader, persisted), position);
+    read(offsetof(FileHeader, stringsLength), stringsLength);
+    if (std::memcmp(data.data(), kRingMagic, sizeof(kRingMagic)) != 0 || version != kRingVersion || slotSize != kSlotSize ||
+        capacity < kMaxSlotsPerRecord || (capacity & (capacity - 1)) != 0 ||
+        data.size() != sizeof(FileHeader) + size_t{capacity} * kSlotSize + kStringAreaSize) {
+        return false;
+    }
+    size_t mask = capacity - 1;
+    auto slotAt = [&](std::uint64_t at) { return sizeof(FileHeader) + static_cast<size_t>(at & mask) * kSlotSize; };
+    auto sequenceAt = [&](std::uint64_t at) {
+        std::uint64_t sequence = 0;
+        read(slotAt(at) + offsetof(Slot, sequence), sequence);
+        return sequence;
+    };
+
+    // Published records are contiguous from the persisted position; the first slot that isn't
+    // one (free, or torn by the crash) ends the tail.
+    std::uint64_t end = position + capacity;
+    while (records && position < end) {
+        if (sequenceAt(position) != position + 1) break;
+        size_t head = slotAt(position);
+        std::uint32_t length = 0;
+        std::uint16_t count = 0;
+        Record record;
+        read(head + offsetof(Slot, timestamp), record.timestamp);
+        read(head + offsetof(Slot, length), length);
+        read(head + offsetof(Slot, slotCount), count);
+        read(head + offsetof(Slot, level), record.level);
+        read(head + offsetof(Slot, kind), record.kind);
+        if (count == 0 || count > kMaxSlotsPerRecord || position + count > end || length > count * kPayloadPerSlot) break;
+
+        bool complete = true;
+        for (size_t i = 1; i < count && complete; ++i) complete = sequenceAt(position + i) == position + i + 1;
+        if (!complete) break;
+
+        size_t remaining = length;
+        for (size_t i = 0; i < count; ++i) {
+            size_t chunk = (std::min)(remaining, kPayloadPerSlot);
+            record.payload.append(data.data() + slotAt(position + i) + offsetof(Slot, payload), chunk);
+            remaining -= chunk;
+        }
+        records->push_back(std::move(record));
+        position += count;
+    }
+
+    std::string_view area = data.substr(sizeof(FileHeader) + size_t{capacity} * kSlotSize);
+    std::uint32_t length = std::min<std::uint32_t>(stringsLength, kStringAreaSize);
+    for (std::uint32_t offset = 0; strings && length - offset >= 8;) {
+        std::uint32_t id, textLength;
+        std::memcpy(&id, area.data() + offset, sizeof(id));
+        std::memcpy(&textLength, area.data() + offset + 4, sizeof(textLength));
+        if (textLength > length - offset - 8) break;
+        if (id < kStringAreaSize) { // ids are small and dense, this only bounds a torn one
+            if (strings->size() <= id) strings->resize(id + 1);
+            (*strings)[id].assign(area.data() + offset + 8, textLength);
+        }
+        offset += 8 + textLength;
+    }
+    return true;
+}
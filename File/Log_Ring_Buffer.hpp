@@ -0,0 +1,176 @@
+#ifndef LOG_RING_BUFFER_HPP
+#define LOG_RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Bounded multi-producer, single-consumer queue of log records in preallocated fixed-size slots.
+// Producers claim slots with a single CAS on the tail and publish them through per-slot sequence
+// numbers, so they never take a lock or allocate. A record longer than one slot spans several
+// consecutive slots. Only the writer thread consumes.
+//
+// The slots can live in a memory-mapped file instead (mapFile), so records a crashed process
+// never wrote out are still on disk. Producers write the mapping like any other memory, without
+// a syscall; drained slots are only reused after markPersisted(), which moves the header's
+// persisted position. The next mapFile() of the same file reads back everything past it.
+class LogRingBuffer {
+public:
+    // What push() does when the ring is full.
+    enum class OverflowPolicy {
+        Block, // wait for the writer to make room
+        Drop,  // discard the record
+        Count  // discard it, and have the writer log how many were lost
+    };
+
+    static constexpr size_t kSlotSize = 256;
+    static constexpr size_t kMaxSlotsPerRecord = 64;
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        std::int64_t timestamp;    // system_clock ticks, head slot only
+        std::uint32_t length;      // payload bytes of the whole record, head slot only
+        std::uint16_t slotCount;   // slots the record spans, head slot only
+        std::uint8_t level;
+        std::uint8_t kind;         // payload format, opaque to the ring
+        char payload[kSlotSize - 24];
+    };
+    static_assert(sizeof(Slot) == kSlotSize, "unexpected log slot padding");
+    static constexpr size_t kPayloadPerSlot = sizeof(Slot::payload);
+    static constexpr size_t kMaxPayload = kPayloadPerSlot * kMaxSlotsPerRecord;
+
+    static constexpr const char* kFileExtension = ".ring";
+    static constexpr size_t kStringAreaSize = 64 * 1024;
+
+    // A record read back from a ring file.
+    struct Record {
+        std::uint8_t level = 0;
+        std::uint8_t kind = 0;
+        std::int64_t timestamp = 0;
+        std::string payload;
+    };
+
+    // slotCount is rounded up to a power of two.
+    explicit LogRingBuffer(size_t slotCount = 8192);
+    ~LogRingBuffer();
+
+    LogRingBuffer(const LogRingBuffer&) = delete;
+    LogRingBuffer& operator=(const LogRingBuffer&) = delete;
+
+    // Payloads over kMaxPayload are truncated. Returns false if the record was dropped;
+    // Block only waits when canBlock is set (i.e. a writer is running to make room).
+    bool push(std::uint8_t level, std::uint8_t kind, std::int64_t timestamp, std::string_view payload, bool canBlock);
+
+    // Consumer side: hands each published record to sink(level, kind, timestamp, payload) in order
+    // and frees its slots afterwards. The payload view is only valid during the call.
+    template<typename Sink>
+    size_t drain(Sink&& sink, size_t maxRecords = SIZE_MAX);
+
+    bool empty() const;
+
+    // Moves the slots, and anything queued in them, into a ring file at path, locked for as long
+    // as it stays mapped. What a previous owner left unpersisted in the file is read into leftover
+    // (oldest first) and strings (by id) before it is overwritten. False if the file is in use.
+    // Call before other threads push or drain.
+    bool mapFile(const fs::path& path, std::vector<Record>* leftover = nullptr, std::vector<std::string>* strings = nullptr);
+    bool isMapped() const { return header_ != nullptr; }
+    // Consumer side, mapped rings: everything drained so far is in the log file.
+    void markPersisted();
+    // Consumer side: slots drained but held until markPersisted(), always 0 unmapped.
+    size_t unpersistedSlots() const { return header_ ? static_cast<size_t>(head_ - released_) : 0; }
+    size_t capacity() const { return capacity_; }
+
+    // Side table kept in the ring file next to the records, e.g. format strings the records
+    // refer to. Locks, so not for the hot path. False if unmapped or the table is full.
+    bool addString(std::uint32_t id, std::string_view text);
+
+    void setPolicy(OverflowPolicy policy) { policy_.store(policy, std::memory_order_relaxed); }
+    OverflowPolicy getPolicy() const { return policy_.load(std::memory_order_relaxed); }
+
+    // Records dropped since construction, and since the last takeDroppedSinceReport().
+    std::uint64_t getDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+    std::uint64_t takeDroppedSinceReport();
+
+private:
+    struct FileHeader;
+
+    bool tryClaim(size_t slots, std::uint64_t& position);
+    void unmapFile();
+    static bool readRingFile(std::string_view data, std::vector<Record>* records, std::vector<std::string>* strings);
+
+    Slot* slots_ = nullptr;
+    std::unique_ptr<Slot[]> heapSlots_;
+    FileHeader* header_ = nullptr;
+    char* strings_ = nullptr;
+    std::mutex stringsMutex_;
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    std::atomic<OverflowPolicy> policy_{OverflowPolicy::Block};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::uint64_t reportedDropped_ = 0;
+
+    alignas(64) std::atomic<std::uint64_t> tail_{0};
+    alignas(64) std::uint64_t head_ = 0; // consumer only
+    std::uint64_t released_ = 0;          // consumer only, mapped rings free slots up to here
+    std::string scratch_;                 // reassembles multi-slot records
+};
+
+template<typename Sink>
+size_t LogRingBuffer::drain(Sink&& sink, size_t maxRecords) {
+    size_t drained = 0;
+    while (drained < maxRecords) {
+        Slot& first = slots_[head_ & mask_];
+        if (first.sequence.load(std::memory_order_acquire) != head_ + 1) break;
+
+        size_t count = first.slotCount;
+        // The producer publishes the continuation slots after the head, wait until all are there.
+        for (size_t i = 1; i < count; ++i) {
+            const Slot& slot = slots_[(head_ + i) & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != head_ + i + 1) return drained;
+        }
+
+        std::string_view payload;
+        if (count == 1) {
+            payload = std::string_view(first.payload, first.length);
+        } else {
+            scratch_.clear();
+            size_t remaining = first.length;
+            for (size_t i = 0; i < count; ++i) {
+                size_t chunk = remaining < kPayloadPerSlot ? remaining : kPayloadPerSlot;
+                scratch_.append(slots_[(head_ + i) & mask_].payload, chunk);
+                remaining -= chunk;
+            }
+            payload = scratch_;
+        }
+
+        sink(first.level, first.kind, first.timestamp, payload);
+
+        // A mapped ring keeps the record until markPersisted(), it's the crash copy.
+        if (!header_) {
+            for (size_t i = 0; i < count; ++i) {
+                slots_[(head_ + i) & mask_].sequence.store(head_ + i + capacity_, std::memory_order_release);
+            }
+        }
+        head_ += count;
+        ++drained;
+    }
+    return drained;
+}
+
+#endif // LOG_RING_BUFFER_HPP
@@ -0,0 +1,255 @@
+// Log_Writer.cpp
+#include "Log_Writer.hpp"
+#include <algorithm>
+#include <cstdio>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+LogWriter::LogWriter() = default;
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+bool LogWriter::open(const fs::path& path) {
+    close();
+    HANDLE file = CreateFileW(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize{};
+    GetFileSizeEx(file, &fileSize);
+    handle_ = file;
+    fileSize_ = static_cast<std::uintmax_t>(fileSize.QuadPart);
+    lastFlush_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool LogWriter::isOpen() const {
+    return handle_ != nullptr;
+}
+
+void LogWriter::close() {
+    if (!handle_) return;
+    flush(syncPending_);
+    consume(buffered_);
+    syncPending_ = false;
+    CloseHandle(handle_);
+    handle_ = nullptr;
+}
+
+// No gather write for buffered handles on Windows, so one WriteFile per chunk.
+bool LogWriter::writeAll(size_t& written) {
+    for (size_t i = 0; i < used_; ++i) {
+        const std::string& chunk = chunks_[i];
+        size_t offset = 0;
+        while (offset < chunk.size()) {
+            DWORD done = 0;
+            DWORD length = static_cast<DWORD>(std::min<size_t>(chunk.size() - offset, 1u << 30));
+            if (!WriteFile(handle_, chunk.data() + offset, length, &done, nullptr)) return false;
+            offset += done;
+            written += done;
+        }
+    }
+    return true;
+}
+
+bool LogWriter::syncFile() {
+    return FlushFileBuffers(handle_) != 0;
+}
+
+#else
+
+bool LogWriter::open(const fs::path& path) {
+    close();
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    fileSize_ = ::fstat(fd, &st) == 0 ? static_cast<std::uintmax_t>(st.st_size) : 0;
+    fd_ = fd;
+    lastFlush_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool LogWriter::isOpen() const {
+    return fd_ >= 0;
+}
+
+void LogWriter::close() {
+    if (fd_ < 0) return;
+    flush(syncPending_);
+    consume(buffered_);
+    syncPending_ = false;
+    ::close(fd_);
+    fd_ = -1;
+}
+
+// Every chunk goes out in as few writev calls as IOV_MAX and short writes allow.
+bool LogWriter::writeAll(size_t& written) {
+    std::vector<iovec> iov;
+    iov.reserve(used_);
+    for (size_t i = 0; i < used_; ++i) {
+        iov.push_back(iovec{const_cast<char*>(chunks_[i].data()), chunks_[i].size()});
+    }
+
+    size_t first = 0;
+    while (first < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX));
+        ssize_t done = ::writev(fd_, iov.data() + first, count);
+        if (done < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        auto remaining = static_cast<size_t>(done);
+        written += remaining;
+        while (first < iov.size() && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+bool LogWriter::syncFile() {
+#if defined(__APPLE__)
+    return ::fsync(fd_) == 0;
+#else
+    return ::fdatasync(fd_) == 0;
+#endif
+}
+
+#endif
+
+std::string& LogWriter::currentChunk() {
+    if (used_ == 0 || chunks_[used_ - 1].size() >= kChunkSize) {
+        if (used_ == chunks_.size()) {
+            chunks_.emplace_back();
+            chunks_.back().reserve(kChunkSize + 1024);
+        }
+        ++used_;
+    }
+    return chunks_[used_ - 1];
+}
+
+bool LogWriter::admit(size_t bytes) {
+    if (policy_.maxBuffered == 0 || buffered_ + bytes <= policy_.maxBuffered) return true;
+    ++dropped_;
+    return false;
+}
+
+void LogWriter::append(std::string_view line, bool important) {
+    if (!admit(line.size() + 1)) return;
+    std::string& chunk = currentChunk();
+    chunk.append(line);
+    chunk.push_back('\n');
+    buffered_ += line.size() + 1;
+    if (important && policy_.syncImportant) syncPending_ = true;
+}
+
+void LogWriter::appendRaw(std::string_view data, bool important) {
+    if (!admit(data.size())) return;
+    currentChunk().append(data);
+    buffered_ += data.size();
+    if (important && policy_.syncImportant) syncPending_ = true;
+}
+
+std::uint64_t LogWriter::takeDroppedSinceReport() {
+    std::uint64_t dropped = dropped_;
+    dropped_ = 0;
+    return dropped;
+}
+
+bool LogWriter::flushIfDue(std::chrono::steady_clock::time_point now) {
+    if (buffered_ == 0 && !syncPending_) return true;
+    bool due = syncPending_ || buffered_ >= policy_.bytes ||
+               (policy_.interval.count() > 0 && now - lastFlush_ >= policy_.interval);
+    return due ? flush(syncPending_) : true;
+}
+
+bool LogWriter::flush(bool sync) {
+    if (!isOpen()) return false;
+
+    bool ok = true;
+    if (buffered_ > 0) {
+        size_t written = 0;
+        ok = writeAll(written);
+        fileSize_ += written;
+        consume(written);
+    }
+    if (ok && sync) {
+        ok = syncFile();
+        if (ok) syncPending_ = false;
+    }
+    lastFlush_ = std::chrono::steady_clock::now();
+    return ok;
+}
+
+// Drops the first written bytes from the buffer, a partial write leaves the rest queued.
+void LogWriter::consume(size_t written) {
+    buffered_ -= written;
+    if (buffered_ == 0) {
+        // Keep the chunks' capacity for the next batch, only drop spares beyond a few.
+        for (size_t i = 0; i < used_; ++i) chunks_[i].clear();
+        if (chunks_.size() > 4) chunks_.resize(4);
+        used_ = 0;
+        return;
+    }
+    size_t done = 0;
+    while (done < used_ && written >= chunks_[done].size()) {
+        written -= chunks_[done].size();
+        chunks_[done++].clear();
+    }
+    chunks_[done].erase(0, written);
+    // Emptied chunks become spares behind the ones still holding data.
+    std::rotate(chunks_.begin(), chunks_.begin() + done, chunks_.begin() + used_);
+    used_ -= done;
+}
+
+std::chrono::steady_clock::time_point LogWriter::nextFlushDue() const {
+    if (buffered_ == 0 || policy_.interval.count() <= 0) return (std::chrono::steady_clock::time_point::max)();
+    return lastFlush_ + policy_.interval;
+}
+
+void LogConsoleSink::write(std::string_view line, std::chrono::steady_clock::time_point now) {
+    if (!enabled_) return;
+
+    if (now - windowStart_ >= std::chrono::seconds(1)) {
+        if (suppressed_ > 0) {
+            pending_ += "... " + std::to_string(suppressed_) + " log lines not echoed (console rate limit)\n";
+        }
+        windowStart_ = now;
+        linesInWindow_ = 0;
+        suppressed_ = 0;
+    }
+
+    if (maxLinesPerSecond_ > 0 && linesInWindow_ >= maxLinesPerSecond_) {
+        ++suppressed_;
+        return;
+    }
+    ++linesInWindow_;
+    pending_.append(line);
+    pending_.push_back('\n');
+}
+
+void LogConsoleSink::flush() {
+    if (pending_.empty()) return;
+    std::fwrite(pending_.data(), 1, pending_.size(), stdout);
+    std::fflush(stdout);
+    pending_.clear();
+}
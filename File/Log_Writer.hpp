@@ -0,0 +1,106 @@
+#ifndef LOG_WRITER_HPP
+#define LOG_WRITER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Append-only log file that stays open and buffers lines in large chunks, written out with one
+// vectored write per flush. When to flush is up to FlushPolicy; lines marked important
+// (WARN/ERROR) make the next flush durable, so every important line of a batch shares one fsync.
+// Single threaded: only the monitor thread uses it.
+class LogWriter {
+public:
+    struct FlushPolicy {
+        std::chrono::milliseconds interval{1000}; // flush at least this often, 0 disables
+        size_t bytes = 64 * 1024;                  // flush once this much is buffered
+        bool syncImportant = true;                 // group commit: fsync batches holding WARN/ERROR
+        size_t maxBuffered = 16 * 1024 * 1024;     // past this, appends are dropped and counted, 0 for no cap
+    };
+
+    static constexpr size_t kChunkSize = 256 * 1024;
+
+    LogWriter();
+    ~LogWriter();
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    bool open(const fs::path& path);
+    // Flushes what is buffered first, durably if a sync is pending; what can't be written is lost.
+    void close();
+    bool isOpen() const;
+
+    void setPolicy(const FlushPolicy& policy) { policy_ = policy; }
+    const FlushPolicy& getPolicy() const { return policy_; }
+
+    // Buffers one line, the newline is added here. Dropped if it would take the buffer past
+    // maxBuffered, which only happens while writes keep failing.
+    void append(std::string_view line, bool important);
+    // Buffers bytes as they are, for binary logs. Dropped whole like append, never cut.
+    void appendRaw(std::string_view data, bool important);
+    // Appends dropped since the last call.
+    std::uint64_t takeDroppedSinceReport();
+
+    // Flushes when the byte threshold, the interval or a pending sync asks for it.
+    bool flushIfDue(std::chrono::steady_clock::time_point now);
+    // False if the write or the sync failed. Bytes that didn't reach the file stay buffered, up
+    // to maxBuffered, and a requested sync stays pending, both are retried by the next flush.
+    bool flush(bool sync = false);
+    bool syncPending() const { return syncPending_; }
+
+    // Size of the file including what is still buffered.
+    std::uintmax_t size() const { return fileSize_ + buffered_; }
+    size_t buffered() const { return buffered_; }
+    // When the interval policy next wants a flush, max() if nothing is buffered.
+    std::chrono::steady_clock::time_point nextFlushDue() const;
+
+private:
+    bool admit(size_t bytes);
+    bool writeAll(size_t& written);
+    bool syncFile();
+    void consume(size_t written);
+    std::string& currentChunk();
+
+    FlushPolicy policy_;
+    std::vector<std::string> chunks_; // chunks_[0..used_) hold data, the rest are spares
+    size_t used_ = 0;
+    size_t buffered_ = 0;
+    std::uint64_t dropped_ = 0;
+    bool syncPending_ = false;
+    std::uintmax_t fileSize_ = 0;
+    std::chrono::steady_clock::time_point lastFlush_;
+#if defined(_WIN32) || defined(_WIN64)
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// Optional console echo of log lines, limited to maxLinesPerSecond so a log burst
+// can't stall the writer on console I/O. Suppressed lines are summarized.
+class LogConsoleSink {
+public:
+    void setEnabled(bool enabled) { enabled_ = enabled; }
+    bool isEnabled() const { return enabled_; }
+    void setRateLimit(size_t maxLinesPerSecond) { maxLinesPerSecond_ = maxLinesPerSecond; }
+
+    void write(std::string_view line, std::chrono::steady_clock::time_point now);
+    // Prints what was collected since the last flush in one write.
+    void flush();
+
+private:
+    bool enabled_ = true;
+    size_t maxLinesPerSecond_ = 100;
+    std::chrono::steady_clock::time_point windowStart_;
+    size_t linesInWindow_ = 0;
+    size_t suppressed_ = 0;
+    std::string pending_;
+};
+
+#endif // LOG_WRITER_HPP
@@ -0,0 +1,144 @@
+// Mapped_File.cpp
+#include "Mapped_File.hpp"
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool readWholeFile(const fs::path& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    in.seekg(0);
+    out.resize(static_cast<size_t>(size));
+    in.read(out.data(), size);
+    // A file that shrank meanwhile just reads short.
+    out.resize(static_cast<size_t>(in.gcount()));
+    return !in.bad();
+}
+
+MappedFile::MappedFile(const fs::path& path) {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        swap(other);
+    }
+    return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(isOpen_, other.isOpen_);
+#if defined(_WIN32) || defined(_WIN64)
+    std::swap(fileHandle_, other.fileHandle_);
+    std::swap(mappingHandle_, other.mappingHandle_);
+#else
+    std::swap(fd_, other.fd_);
+#endif
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+bool MappedFile::open(const fs::path& path) {
+    close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle_ = file;
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    isOpen_ = true;
+    if (size_ == 0) return true; // zero length files can't be mapped
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mappingHandle_ = mapping;
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mappingHandle_) CloseHandle(mappingHandle_);
+    if (fileHandle_) CloseHandle(fileHandle_);
+    data_ = nullptr;
+    mappingHandle_ = nullptr;
+    fileHandle_ = nullptr;
+    size_ = 0;
+    isOpen_ = false;
+}
+
+#else
+
+bool MappedFile::open(const fs::path& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    size_ = static_cast<size_t>(st.st_size);
+    isOpen_ = true;
+    if (size_ == 0) return true; // zero length files can't be mapped
+
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+        close();
+        return false;
+    }
+    madvise(addr, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(addr);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    fd_ = -1;
+    size_ = 0;
+    isOpen_ = false;
+}
+
+#endif
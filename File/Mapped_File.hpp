@@ -0,0 +1,49 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace fs = std::filesystem;
+
+// Read-only memory mapping of a whole file. Empty files open successfully with an empty view.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const fs::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const fs::path& path);
+    void close();
+
+    bool isOpen() const { return isOpen_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    void swap(MappedFile& other) noexcept;
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool isOpen_ = false;
+#if defined(_WIN32) || defined(_WIN64)
+    void* fileHandle_ = nullptr;
+    void* mappingHandle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// Reads a whole file into out with plain reads. Use it for files another writer may truncate
+// in place: touching a mapping past the new end of the file faults (SIGBUS) instead of failing.
+bool readWholeFile(const fs::path& path, std::string& out);
+
+#endif // MAPPED_FILE_HPP
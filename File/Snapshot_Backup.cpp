@@ -0,0 +1,284 @@
+// Snapshot_Backup.cpp
+#include "Snapshot_Backup.hpp"
+#include "Fast_Hash.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr const char* kPartialSuffix = ".partial";
+
+std::int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::int64_t mtimeTicks(fs::file_time_type time) {
+    return static_cast<std::int64_t>(time.time_since_epoch().count());
+}
+
+} // namespace
+
+SnapshotBackup::SnapshotBackup(const fs::path& backupRoot, const std::string& name)
+    : SnapshotBackup(backupRoot, name, RetentionPolicy{}) {
+}
+
+SnapshotBackup::SnapshotBackup(const fs::path& backupRoot, const std::string& name, RetentionPolicy policy)
+    : backupRoot_(backupRoot), name_(name), policy_(policy) {
+}
+
+SnapshotBackup::Result SnapshotBackup::create(const fs::path& source, bool recursive, const Filter& filter) {
+    Result result;
+    fs::path partial;
+    try {
+        fs::create_directories(backupRoot_);
+
+        // Diff against the newest snapshot, if its manifest is readable.
+        auto snapshots = listSnapshots();
+        fs::path previous;
+        Manifest previousManifest;
+        if (!snapshots.empty() && readManifest(snapshots.back(), previousManifest)) {
+            previous = snapshots.back();
+        }
+
+        // Reserve a name: the .partial directory is created exclusively, the final one must be free.
+        std::int64_t created = nowSeconds();
+        fs::path target;
+        for (int seq = 0; target.empty(); ++seq) {
+            std::string dirName = name_ + "_" + std::to_string(created);
+            if (seq > 0) dirName += "_" + std::to_string(seq);
+            fs::path candidate = backupRoot_ / dirName;
+            if (fs::exists(candidate)) continue;
+            fs::path candidatePartial = backupRoot_ / (dirName + kPartialSuffix);
+            if (!fs::create_directory(candidatePartial)) continue;
+            target = candidate;
+            partial = candidatePartial;
+        }
+
+        Manifest manifest;
+        std::vector<CopyEngine::Job> copies;
+        bool changed = previous.empty();
+
+        // Other threads delete files here meanwhile (e.g. the log compressor), skip those.
+        auto vanished = [](const fs::path& file) {
+            std::error_code ec;
+            return !fs::exists(file, ec) && !ec;
+        };
+
+        auto addFile = [&](const fs::path& file) {
+            fs::path relative = file.lexically_relative(source);
+            if (filter && !filter(relative)) return;
+
+            ManifestEntry entry;
+            std::error_code ec;
+            entry.size = fs::file_size(file, ec);
+            fs::file_time_type mtime;
+            if (!ec) mtime = fs::last_write_time(file, ec);
+            if (ec) {
+                if (vanished(file)) return;
+                throw fs::filesystem_error("cannot stat file", file, ec);
+            }
+            entry.mtime = mtimeTicks(mtime);
+            std::string key = relative.generic_string();
+
+            // Quick check on size and mtime first, only hash what may have changed.
+            auto prev = previousManifest.find(key);
+            bool same = false;
+            if (prev != previousManifest.end() && prev->second.size == entry.size && prev->second.mtime == entry.mtime) {
+                entry.hash = prev->second.hash;
+                same = true;
+            } else {
+                auto hash = fast_hash::hashFile(file);
+                if (!hash && vanished(file)) return;
+                if (!hash) throw fs::filesystem_error("cannot read file", file, std::make_error_code(std::errc::io_error));
+                entry.hash = *hash;
+                same = prev != previousManifest.end() && prev->second.hash == entry.hash && prev->second.size == entry.size;
+            }
+
+            fs::path destination = partial / kFilesDir / relative;
+            fs::create_directories(destination.parent_path());
+
+            bool linked = false;
+            if (same) {
+                // Snapshots from before kFilesDir have nothing to link to there and copy instead.
+                fs::create_hard_link(previous / kFilesDir / relative, destination, ec);
+                linked = !ec; // e.g. FAT volumes or the link count limit, copy instead
+            }
+            if (linked) {
+                ++result.filesLinked;
+            } else {
+                copies.push_back({file, destination, entry.size});
+                if (!same) changed = true;
+            }
+            manifest.emplace(std::move(key), entry);
+        };
+
+        // Made up front so a snapshot of an empty source has the same layout.
+        fs::create_directories(partial / kFilesDir);
+        std::error_code typeError;
+        if (recursive) {
+            for (const auto& entry : fs::recursive_directory_iterator(source)) {
+                if (entry.is_regular_file(typeError)) addFile(entry.path());
+            }
+        } else {
+            for (const auto& entry : fs::directory_iterator(source)) {
+                if (entry.is_regular_file(typeError)) addFile(entry.path());
+            }
+        }
+
+        // Deleted files also count as a change.
+        if (!changed && manifest.size() != previousManifest.size()) changed = true;
+
+        if (!changed) {
+            fs::remove_all(partial);
+            result.ok = true;
+            result.unchanged = true;
+            result.snapshotPath = previous;
+            return result;
+        }
+
+        auto stats = CopyEngine::shared().copy(copies, progress_);
+        if (stats.filesFailed > 0) {
+            // Failures of files deleted since the walk only leave them out.
+            size_t failed = stats.filesFailed;
+            for (const auto& job : copies) {
+                std::error_code ec;
+                if (failed == 0 || fs::exists(job.to, ec) || !vanished(job.from)) continue;
+                manifest.erase(job.to.lexically_relative(partial / kFilesDir).generic_string());
+                --failed;
+            }
+            if (failed > 0) {
+                throw std::runtime_error("copy failed for " + std::to_string(failed) + " files: " + stats.error);
+            }
+        }
+        result.filesCopied = stats.filesCopied;
+        result.bytesCopied = stats.bytesCopied;
+        result.bytesPerSecond = stats.bytesPerSecond;
+
+        if (!writeManifest(partial, manifest, created)) {
+            throw fs::filesystem_error("cannot write manifest", partial, std::make_error_code(std::errc::io_error));
+        }
+        fs::rename(partial, target);
+        result.snapshotPath = target;
+        result.ok = true;
+        result.pruned = prune();
+        return result;
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        if (!partial.empty()) {
+            std::error_code ec;
+            fs::remove_all(partial, ec);
+        }
+        return result;
+    }
+}
+
+size_t SnapshotBackup::prune() {
+    size_t removed = 0;
+    try {
+        auto snapshots = listSnapshots();
+        if (snapshots.size() <= 1) return 0;
+
+        std::int64_t now = nowSeconds();
+        std::int64_t maxAge = std::chrono::duration_cast<std::chrono::seconds>(policy_.maxAge).count();
+
+        // snapshots is oldest first and the last one always stays.
+        for (size_t i = 0; i + 1 < snapshots.size(); ++i) {
+            size_t newerCount = snapshots.size() - i;
+            bool tooMany = policy_.keepLast > 0 && newerCount > policy_.keepLast;
+            bool tooOld = false;
+            if (maxAge > 0) {
+                auto created = snapshotCreated(snapshots[i]);
+                tooOld = created && now - *created > maxAge;
+            }
+            if (!tooMany && !tooOld) continue;
+
+            // Removing a snapshot only drops its links, newer snapshots keep the shared data.
+            std::error_code ec;
+            fs::remove_all(snapshots[i], ec);
+            if (!ec) ++removed;
+        }
+    } catch (...) {
+        // leave the rest for the next run
+    }
+    return removed;
+}
+
+std::vector<fs::path> SnapshotBackup::listSnapshots() const {
+    std::vector<std::pair<std::int64_t, fs::path>> found;
+    std::error_code ec;
+    if (!fs::is_directory(backupRoot_, ec)) return {};
+
+    std::string prefix = name_ + "_";
+    for (const auto& entry : fs::directory_iterator(backupRoot_, ec)) {
+        if (!entry.is_directory()) continue;
+        std::string dirName = entry.path().filename().string();
+        if (dirName.compare(0, prefix.size(), prefix) != 0) continue;
+        if (dirName.ends_with(kPartialSuffix)) continue;
+
+        // The prefix alone is ambiguous ("a" vs "a_1"), the manifest header settles it.
+        if (auto created = snapshotCreated(entry.path())) {
+            found.emplace_back(*created, entry.path());
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+    std::vector<fs::path> snapshots;
+    snapshots.reserve(found.size());
+    for (auto& item : found) snapshots.push_back(std::move(item.second));
+    return snapshots;
+}
+
+// Manifest layout:
+//   # snapshot <created seconds> <name>
+//   <hash hex>\t<size>\t<mtime ticks>\t<relative path>
+bool SnapshotBackup::readManifest(const fs::path& snapshot, Manifest& manifest) const {
+    std::ifstream ifs(snapshot / kManifestName);
+    if (!ifs) return false;
+
+    std::string line;
+    std::getline(ifs, line); // header
+    while (std::getline(ifs, line)) {
+        size_t a = line.find('\t');
+        size_t b = a == std::string::npos ? a : line.find('\t', a + 1);
+        size_t c = b == std::string::npos ? b : line.find('\t', b + 1);
+        if (c == std::string::npos) return false;
+        try {
+            ManifestEntry entry;
+            entry.hash = std::stoull(line.substr(0, a), nullptr, 16);
+            entry.size = std::stoull(line.substr(a + 1, b - a - 1));
+            entry.mtime = std::stoll(line.substr(b + 1, c - b - 1));
+            manifest[line.substr(c + 1)] = entry;
+        } catch (...) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SnapshotBackup::writeManifest(const fs::path& snapshot, const Manifest& manifest, std::int64_t created) const {
+    std::ofstream ofs(snapshot / kManifestName, std::ios::trunc);
+    if (!ofs) return false;
+    ofs << "# snapshot " << created << " " << name_ << "\n";
+    for (const auto& [path, entry] : manifest) {
+        ofs << fast_hash::toHex(entry.hash) << "\t" << entry.size << "\t" << entry.mtime << "\t" << path << "\n";
+    }
+    return static_cast<bool>(ofs);
+}
+
+std::optional<std::int64_t> SnapshotBackup::snapshotCreated(const fs::path& dir) const {
+    std::ifstream ifs(dir / kManifestName);
+    if (!ifs) return std::nullopt;
+
+    std::string line;
+    std::getline(ifs, line);
+    std::istringstream header(line);
+    std::string hash, tag, name;
+    std::int64_t created = 0;
+    if (!(header >> hash >> tag >> created) || hash != "#" || tag != "snapshot") return std::nullopt;
+    std::getline(header >> std::ws, name);
+    if (name != name_) return std::nullopt;
+    return created;
+}
@@ -0,0 +1,83 @@
+#ifndef SNAPSHOT_BACKUP_HPP
+#define SNAPSHOT_BACKUP_HPP
+
+#include "Copy_Engine.hpp"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Incremental snapshots of a directory under backupRoot/<name>_<seconds>.
+// Every snapshot is complete on its own, but files whose content hash matches the previous
+// snapshot are hardlinked from it instead of copied, so cost scales with what changed.
+// Each snapshot carries a manifest (hash, size, mtime, relative path) that the next one diffs against.
+// The files go in a kFilesDir subdirectory next to it, so no source file can take the manifest's place.
+class SnapshotBackup {
+public:
+    struct RetentionPolicy {
+        size_t keepLast = 10;                // 0 keeps any number
+        std::chrono::hours maxAge{24 * 7};   // 0 keeps any age
+    };
+
+    struct Result {
+        bool ok = false;
+        bool unchanged = false;              // nothing differed, no new snapshot was written
+        fs::path snapshotPath;               // the new snapshot, or the previous one when unchanged
+        size_t filesCopied = 0;
+        size_t filesLinked = 0;
+        std::uintmax_t bytesCopied = 0;
+        double bytesPerSecond = 0.0;
+        size_t pruned = 0;
+        std::string error;
+    };
+
+    // Gets the path relative to the source, returns false to leave the file out.
+    using Filter = std::function<bool(const fs::path& relative)>;
+
+    static constexpr const char* kManifestName = "manifest.txt";
+    static constexpr const char* kFilesDir = "files";
+
+    SnapshotBackup(const fs::path& backupRoot, const std::string& name);
+    SnapshotBackup(const fs::path& backupRoot, const std::string& name, RetentionPolicy policy);
+
+    // Reports the copy phase of create(), see CopyEngine::ProgressCallback.
+    void setProgressCallback(CopyEngine::ProgressCallback progress) { progress_ = std::move(progress); }
+
+    // Snapshots the regular files in source, then applies the retention policy.
+    // Files that need copying go through CopyEngine::shared() in parallel. Files that vanish
+    // while the snapshot is taken are left out of it.
+    Result create(const fs::path& source, bool recursive = true, const Filter& filter = {});
+
+    // Removes snapshots outside the retention policy, the newest is always kept.
+    size_t prune();
+
+    // Snapshot directories belonging to this name, oldest first.
+    std::vector<fs::path> listSnapshots() const;
+
+private:
+    struct ManifestEntry {
+        std::uint64_t hash = 0;
+        std::uintmax_t size = 0;
+        std::int64_t mtime = 0;
+    };
+    // Keyed by generic relative path.
+    using Manifest = std::unordered_map<std::string, ManifestEntry>;
+
+    bool readManifest(const fs::path& snapshot, Manifest& manifest) const;
+    bool writeManifest(const fs::path& snapshot, const Manifest& manifest, std::int64_t created) const;
+    // Creation time from the manifest header, nullopt if dir isn't one of our snapshots.
+    std::optional<std::int64_t> snapshotCreated(const fs::path& dir) const;
+
+    fs::path backupRoot_;
+    std::string name_;
+    RetentionPolicy policy_;
+    CopyEngine::ProgressCallback progress_;
+};
+
+#endif // SNAPSHOT_BACKUP_HPP
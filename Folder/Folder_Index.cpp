@@ -0,0 +1,351 @@
+// Folder_Index.cpp
+#include "Folder_Index.hpp"
+#include "../File/Fast_Hash.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+std::string joinKey(const std::string& directory, const std::string& name) {
+    return directory.empty() ? name : directory + "/" + name;
+}
+
+bool isBelow(const std::string& key, const std::string& directory) {
+    if (directory.empty()) return true;
+    return key.size() > directory.size() && key.compare(0, directory.size(), directory) == 0 &&
+           key[directory.size()] == '/';
+}
+
+} // namespace
+
+FolderIndex::FolderIndex(const fs::path& root, bool hashContents, size_t threads)
+    : root(root), hashContents(hashContents), threadCount(threads) {
+    if (threadCount == 0) threadCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 16);
+}
+
+bool FolderIndex::build() {
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) return false;
+
+    WalkResult result = walk(root, false);
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    files.clear();
+    directories.clear();
+    mergeTree("", std::move(result));
+    return true;
+}
+
+bool FolderIndex::refresh() {
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) return false;
+
+    WalkResult result;
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        result = walk(root, true);
+    }
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    files.clear();
+    directories.clear();
+    mergeTree("", std::move(result));
+    return true;
+}
+
+void FolderIndex::update(const fs::path& path) {
+    auto key = relativeKey(path);
+    if (!key || key->empty()) return;
+
+    std::error_code ec;
+    fs::directory_entry entry(path, ec);
+    std::optional<Entry> stat;
+    if (!ec && entry.is_regular_file(ec)) {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        stat = statFile(entry, *key);
+    }
+
+    size_t slash = key->find_last_of('/');
+    std::string parent = slash == std::string::npos ? std::string() : key->substr(0, slash);
+    std::string name = slash == std::string::npos ? *key : key->substr(slash + 1);
+
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    auto dir = directories.find(parent);
+    if (stat) {
+        files[*key] = std::move(*stat);
+        if (dir != directories.end() &&
+            std::find(dir->second.files.begin(), dir->second.files.end(), name) == dir->second.files.end()) {
+            dir->second.files.push_back(name);
+        }
+    } else {
+        files.erase(*key);
+        if (dir != directories.end()) {
+            auto& names = dir->second.files;
+            names.erase(std::remove(names.begin(), names.end(), name), names.end());
+        }
+    }
+}
+
+void FolderIndex::updateTree(const fs::path& directory) {
+    auto key = relativeKey(directory);
+    if (!key) return;
+
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        removeTree(directory);
+        return;
+    }
+
+    WalkResult result;
+    {
+        std::shared_lock<std::shared_mutex> lock(indexMutex);
+        result = walk(directory, true);
+    }
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    eraseTree(*key);
+    mergeTree(*key, std::move(result));
+}
+
+void FolderIndex::removeTree(const fs::path& directory) {
+    auto key = relativeKey(directory);
+    if (!key) return;
+    std::unique_lock<std::shared_mutex> lock(indexMutex);
+    eraseTree(*key);
+}
+
+std::vector<FolderIndex::Entry> FolderIndex::find(const Query& query) const {
+    bool nameOnly = query.glob.find('/') == std::string::npos;
+    std::vector<Entry> matches;
+
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    for (const auto& [key, entry] : files) {
+        if (query.minSize && entry.size < *query.minSize) continue;
+        if (query.maxSize && entry.size > *query.maxSize) continue;
+        if (query.modifiedAfter && entry.mtime <= *query.modifiedAfter) continue;
+        if (query.modifiedBefore && entry.mtime >= *query.modifiedBefore) continue;
+        if (!query.glob.empty()) {
+            std::string_view subject = key;
+            if (nameOnly) {
+                size_t slash = subject.find_last_of('/');
+                if (slash != std::string_view::npos) subject.remove_prefix(slash + 1);
+            }
+            if (!globMatch(query.glob, subject)) continue;
+        }
+        matches.push_back(entry);
+    }
+    lock.unlock();
+
+    std::sort(matches.begin(), matches.end(), [](const Entry& a, const Entry& b) { return a.path < b.path; });
+    return matches;
+}
+
+std::vector<FolderIndex::Entry> FolderIndex::findGlob(const std::string& pattern) const {
+    Query query;
+    query.glob = pattern;
+    return find(query);
+}
+
+std::vector<FolderIndex::Entry> FolderIndex::findBySize(std::uintmax_t minSize, std::uintmax_t maxSize) const {
+    Query query;
+    query.minSize = minSize;
+    query.maxSize = maxSize;
+    return find(query);
+}
+
+std::vector<FolderIndex::Entry> FolderIndex::findOlderThan(std::chrono::seconds age) const {
+    Query query;
+    query.modifiedBefore = fs::file_time_type::clock::now() - age;
+    return find(query);
+}
+
+std::vector<FolderIndex::Entry> FolderIndex::findNewerThan(std::chrono::seconds age) const {
+    Query query;
+    query.modifiedAfter = fs::file_time_type::clock::now() - age;
+    return find(query);
+}
+
+std::optional<FolderIndex::Entry> FolderIndex::lookup(const fs::path& path) const {
+    auto key = relativeKey(path.is_absolute() ? path : root / path);
+    if (!key) return std::nullopt;
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    auto it = files.find(*key);
+    if (it == files.end()) return std::nullopt;
+    return it->second;
+}
+
+size_t FolderIndex::fileCount() const {
+    std::shared_lock<std::shared_mutex> lock(indexMutex);
+    return files.size();
+}
+
+bool FolderIndex::globMatch(std::string_view pattern, std::string_view path) {
+    size_t p = 0;
+    size_t s = 0;
+    while (p < pattern.size()) {
+        if (pattern.compare(p, 2, "**") == 0) {
+            std::string_view rest = pattern.substr(p + 2);
+            // "a/**/b" also matches "a/b"
+            if (!rest.empty() && rest.front() == '/' && globMatch(rest.substr(1), path.substr(s))) return true;
+            for (size_t k = s; k <= path.size(); ++k) {
+                if (globMatch(rest, path.substr(k))) return true;
+            }
+            return false;
+        }
+        if (pattern[p] == '*') {
+            std::string_view rest = pattern.substr(p + 1);
+            for (size_t k = s; k <= path.size(); ++k) {
+                if (globMatch(rest, path.substr(k))) return true;
+                if (k < path.size() && path[k] == '/') break;
+            }
+            return false;
+        }
+        if (s == path.size()) return false;
+        if (pattern[p] == '?' ? path[s] == '/' : pattern[p] != path[s]) return false;
+        ++p;
+        ++s;
+    }
+    return s == path.size();
+}
+
+FolderIndex::WalkResult FolderIndex::walk(const fs::path& start, bool incremental) const {
+    WalkResult result;
+    std::mutex walkMutex;
+    std::condition_variable walkCv;
+    std::deque<fs::path> queue{start};
+    size_t busy = 0;
+
+    auto worker = [&]() {
+        WalkResult local;
+        while (true) {
+            fs::path directory;
+            {
+                std::unique_lock<std::mutex> lock(walkMutex);
+                walkCv.wait(lock, [&]() { return !queue.empty() || busy == 0; });
+                if (queue.empty()) break;
+                directory = std::move(queue.front());
+                queue.pop_front();
+                ++busy;
+            }
+
+            std::vector<fs::path> found;
+            std::error_code ec;
+            auto key = relativeKey(directory);
+            auto mtime = fs::last_write_time(directory, ec);
+            if (key && !ec) {
+                DirectoryState state;
+                state.mtime = mtime;
+
+                auto known = incremental ? directories.find(*key) : directories.end();
+                if (known != directories.end() && known->second.mtime == mtime) {
+                    // Same entry list as last time: files may still have been rewritten in place.
+                    state = known->second;
+                    for (const auto& name : state.files) {
+                        fs::directory_entry entry(directory / name, ec);
+                        if (ec) continue;
+                        if (auto file = statFile(entry, joinKey(*key, name))) local.files.push_back(std::move(*file));
+                    }
+                    for (const auto& name : state.subdirectories) found.push_back(directory / name);
+                } else {
+                    fs::directory_iterator end;
+                    for (fs::directory_iterator it(directory, ec); !ec && it != end; it.increment(ec)) {
+                        const fs::directory_entry& entry = *it;
+                        std::error_code entryEc;
+                        std::string name = entry.path().filename().string();
+                        if (entry.is_symlink(entryEc)) continue;
+                        if (entry.is_directory(entryEc)) {
+                            state.subdirectories.push_back(name);
+                            found.push_back(entry.path());
+                        } else if (entry.is_regular_file(entryEc)) {
+                            if (auto file = statFile(entry, joinKey(*key, name))) {
+                                state.files.push_back(name);
+                                local.files.push_back(std::move(*file));
+                            }
+                        }
+                    }
+                }
+                local.directories.emplace(*key, std::move(state));
+            }
+
+            std::lock_guard<std::mutex> lock(walkMutex);
+            for (auto& path : found) queue.push_back(std::move(path));
+            --busy;
+            walkCv.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(walkMutex);
+        for (auto& file : local.files) result.files.push_back(std::move(file));
+        for (auto& dir : local.directories) result.directories.insert(std::move(dir));
+    };
+
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threadCount; ++i) helpers.emplace_back(worker);
+    worker();
+    for (auto& helper : helpers) helper.join();
+    return result;
+}
+
+std::optional<std::string> FolderIndex::relativeKey(const fs::path& path) const {
+    fs::path relative = path.lexically_normal().lexically_relative(root.lexically_normal());
+    if (relative.empty()) return std::nullopt;
+    std::string key = relative.generic_string();
+    if (key == ".") return std::string();
+    if (key == ".." || key.compare(0, 3, "../") == 0) return std::nullopt;
+    return key;
+}
+
+// indexMutex must be held (shared is enough): reuses the previous hash when size and mtime match.
+std::optional<FolderIndex::Entry> FolderIndex::statFile(const fs::directory_entry& entry, const std::string& key) const {
+    std::error_code ec;
+    Entry file;
+    file.path = key;
+    file.size = entry.file_size(ec);
+    if (ec) return std::nullopt;
+    file.mtime = entry.last_write_time(ec);
+    if (ec) return std::nullopt;
+
+    if (hashContents) {
+        auto previous = files.find(key);
+        if (previous != files.end() && previous->second.hash &&
+            previous->second.size == file.size && previous->second.mtime == file.mtime) {
+            file.hash = previous->second.hash;
+        } else {
+            file.hash = fast_hash::hashFile(entry.path());
+        }
+    }
+    return file;
+}
+
+void FolderIndex::eraseTree(const std::string& key) {
+    for (auto it = files.begin(); it != files.end();) {
+        if (isBelow(it->first, key)) it = files.erase(it);
+        else ++it;
+    }
+    for (auto it = directories.begin(); it != directories.end();) {
+        if (it->first == key || isBelow(it->first, key)) it = directories.erase(it);
+        else ++it;
+    }
+}
+
+void FolderIndex::mergeTree(const std::string& key, WalkResult&& result) {
+    for (auto& file : result.files) {
+        std::string fileKey = file.path;
+        files[std::move(fileKey)] = std::move(file);
+    }
+    for (auto& dir : result.directories) directories[dir.first] = std::move(dir.second);
+
+    // Hook the subtree into its parent so an unchanged parent still visits it on refresh.
+    if (key.empty()) return;
+    size_t slash = key.find_last_of('/');
+    std::string parent = slash == std::string::npos ? std::string() : key.substr(0, slash);
+    std::string name = slash == std::string::npos ? key : key.substr(slash + 1);
+    auto dir = directories.find(parent);
+    if (dir != directories.end()) {
+        auto& subdirectories = dir->second.subdirectories;
+        bool present = std::find(subdirectories.begin(), subdirectories.end(), name) != subdirectories.end();
+        if (!present && result.directories.count(key)) subdirectories.push_back(name);
+        if (present && !result.directories.count(key)) {
+            subdirectories.erase(std::remove(subdirectories.begin(), subdirectories.end(), name), subdirectories.end());
+        }
+    }
+}
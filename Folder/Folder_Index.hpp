@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// In-memory index of every regular file below a root directory. Built with a parallel
+// directory walk; afterwards single files and subtrees are updated as they change, and
+// refresh() only re-lists directories whose mtime moved and only re-hashes changed files.
+class FolderIndex {
+public:
+    struct Entry {
+        std::string path;                   // relative to the root, '/' separated
+        std::uintmax_t size = 0;
+        fs::file_time_type mtime;
+        std::optional<std::uint64_t> hash;  // XXH64, only when hashing is enabled
+    };
+
+    // Every set field must match.
+    struct Query {
+        // '*' and '?' stop at '/', '**' crosses directories. A pattern without '/' matches the file name.
+        std::string glob;
+        std::optional<std::uintmax_t> minSize;
+        std::optional<std::uintmax_t> maxSize;
+        std::optional<fs::file_time_type> modifiedAfter;
+        std::optional<fs::file_time_type> modifiedBefore;
+    };
+
+    // 0 threads picks the hardware concurrency
+    explicit FolderIndex(const fs::path& root, bool hashContents = false, size_t threads = 0);
+
+    // Full parallel walk, replaces the whole index
+    bool build();
+
+    // Re-checks the tree: unchanged directories aren't listed again, unchanged files aren't re-hashed
+    bool refresh();
+
+    // Re-stat one file (or drop it if it's gone)
+    void update(const fs::path& path);
+
+    // Re-walk one subtree, dropping what no longer exists below it
+    void updateTree(const fs::path& directory);
+
+    // Drop everything below a directory that was deleted
+    void removeTree(const fs::path& directory);
+
+    // Queries never touch the disk
+    std::vector<Entry> find(const Query& query) const;
+    std::vector<Entry> findGlob(const std::string& pattern) const;
+    std::vector<Entry> findBySize(std::uintmax_t minSize, std::uintmax_t maxSize) const;
+    std::vector<Entry> findOlderThan(std::chrono::seconds age) const;
+    std::vector<Entry> findNewerThan(std::chrono::seconds age) const;
+    std::optional<Entry> lookup(const fs::path& path) const;
+
+    size_t fileCount() const;
+    const fs::path& getRoot() const { return root; }
+
+    static bool globMatch(std::string_view pattern, std::string_view path);
+
+private:
+    // A directory as of its last listing; names are relative to the directory
+    struct DirectoryState {
+        fs::file_time_type mtime;
+        std::vector<std::string> files;
+        std::vector<std::string> subdirectories;
+    };
+
+    struct WalkResult {
+        std::vector<Entry> files;
+        std::unordered_map<std::string, DirectoryState> directories;
+    };
+
+    // Walks a directory tree in parallel. With incremental set (and indexMutex held shared),
+    // directories whose mtime is unchanged aren't listed again, only their known files re-stat'ed.
+    WalkResult walk(const fs::path& start, bool incremental) const;
+    // Key relative to the root, nullopt for paths outside it
+    std::optional<std::string> relativeKey(const fs::path& path) const;
+    std::optional<Entry> statFile(const fs::directory_entry& entry, const std::string& key) const;
+    // indexMutex must be held exclusively
+    void eraseTree(const std::string& key);
+    void mergeTree(const std::string& key, WalkResult&& result);
+
+    fs::path root;
+    bool hashContents;
+    size_t threadCount;
+
+    mutable std::shared_mutex indexMutex;
+    std::unordered_map<std::string, Entry> files;
+    std::unordered_map<std::string, DirectoryState> directories;
+};
@@ -1,8 +1,8 @@
 // Folder_System.cpp
 #include "Folder_System.hpp"
-#include <sstream>
-#include <iomanip>
-#include <chrono>
+#include "../File/Log_Modules.hpp"
+#include "../File/Snapshot_Backup.hpp"
+#include <algorithm>
 
 FolderSystem::FolderSystem(const std::string& appName, size_t maxLogSize)
     : appName(appName),
@@ -20,6 +20,7 @@ FolderSystem::FolderSystem(const std::string& appName, size_t maxLogSize)
     baseAppDataPath = "/tmp"; // Fallback
 #endif
     baseAppDataPath += "/Tutones_External_Mod_Menu/" + appName;
+    folderIndex = std::make_unique<FolderIndex>(baseAppDataPath);
 }
 
 FolderSystem::~FolderSystem() {
@@ -34,9 +35,18 @@ bool FolderSystem::initialize() {
             return false;
         }
 
+        // Module logging (RLOG_*) goes to our log unless someone else claimed it first. Only now:
+        // other threads log through the target, and initialize() moves the log ring into its file.
+        if (!LogModules::getTarget()) LogModules::setTarget(fileSystem.get());
+
         // Create base directory if not already created
         fs::create_directories(baseAppDataPath);
-        log("Folder system initialized at: " + baseAppDataPath);
+        // Whatever is left in staging belongs to writes an earlier run never finished
+        fs::remove_all(getStagingPath());
+        fs::create_directories(getStagingPath());
+        folderIndex->build();
+        log("Folder system initialized at: " + baseAppDataPath + " (" +
+            std::to_string(folderIndex->fileCount()) + " files indexed)");
         return true;
     }
     catch (const fs::filesystem_error& e) {
@@ -46,7 +56,8 @@ bool FolderSystem::initialize() {
 }
 
 bool FolderSystem::createFolder(const std::string& folderName) {
-    std::lock_guard<std::mutex> lock(folderMutex);
+    auto folderLock = getFolderLock(folderName);
+    std::unique_lock<std::shared_mutex> lock(*folderLock);
     try {
         std::string folderPath = getFolderPath(folderName);
         if (fs::exists(folderPath)) {
@@ -55,7 +66,10 @@ bool FolderSystem::createFolder(const std::string& folderName) {
         }
 
         fs::create_directory(folderPath);
-        managedFolders.push_back(folderName);
+        {
+            std::unique_lock<std::shared_mutex> registryLock(registryMutex);
+            managedFolders.push_back(folderName);
+        }
         log("Created folder: " + folderName);
         return true;
     }
@@ -66,7 +80,8 @@ bool FolderSystem::createFolder(const std::string& folderName) {
 }
 
 bool FolderSystem::deleteFolder(const std::string& folderName) {
-    std::lock_guard<std::mutex> lock(folderMutex);
+    auto folderLock = getFolderLock(folderName);
+    std::unique_lock<std::shared_mutex> lock(*folderLock);
     try {
         std::string folderPath = getFolderPath(folderName);
         if (!fs::exists(folderPath)) {
@@ -75,10 +90,15 @@ bool FolderSystem::deleteFolder(const std::string& folderName) {
         }
 
         fs::remove_all(folderPath);
-        managedFolders.erase(
-            std::remove(managedFolders.begin(), managedFolders.end(), folderName),
-            managedFolders.end()
-        );
+        contentCache.invalidateTree(folderPath);
+        folderIndex->removeTree(folderPath);
+        {
+            std::unique_lock<std::shared_mutex> registryLock(registryMutex);
+            managedFolders.erase(
+                std::remove(managedFolders.begin(), managedFolders.end(), folderName),
+                managedFolders.end()
+            );
+        }
         log("Deleted folder: " + folderName);
         return true;
     }
@@ -89,7 +109,8 @@ bool FolderSystem::deleteFolder(const std::string& folderName) {
 }
 
 bool FolderSystem::createFileInFolder(const std::string& folderName, const std::string& filename, const std::string& content) {
-    std::lock_guard<std::mutex> lock(folderMutex);
+    auto folderLock = getFolderLock(folderName);
+    std::unique_lock<std::shared_mutex> lock(*folderLock);
     try {
         std::string folderPath = getFolderPath(folderName);
         if (!fs::exists(folderPath)) {
@@ -97,11 +118,8 @@ bool FolderSystem::createFileInFolder(const std::string& folderName, const std::
             return false;
         }
 
-        // Temporarily adjust FileSystem's base path for this operation
-        std::string originalPath = fileSystem->getAppDataPath() + "/Tutones_External_Mod_Menu/" + appName;
-        std::string tempPath = originalPath + "/" + folderName;
-        // Note: FileSystem needs a method to set temporary path or we handle path manually
-        std::string fullPath = tempPath + "/" + filename;
+        // Same folder path the reads and backups use
+        std::string fullPath = folderPath + "/" + filename;
         std::ofstream file(fullPath);
         if (!file.is_open()) {
             log("Failed to create file " + filename + " in folder " + folderName);
@@ -110,7 +128,9 @@ bool FolderSystem::createFileInFolder(const std::string& folderName, const std::
 
         file << content;
         file.close();
-        log("Created file " + filename + " in folder " + folderName);
+        contentCache.invalidate(fullPath);
+        folderIndex->update(fullPath);
+        RLOG_TO(fileSystem.get(), FolderSystem, Info, "Created file {} in folder {}", filename, folderName);
         return true;
     }
     catch (const std::exception& e) {
@@ -120,34 +140,101 @@ bool FolderSystem::createFileInFolder(const std::string& folderName, const std::
 }
 
 std::string FolderSystem::readFileInFolder(const std::string& folderName, const std::string& filename) {
-    std::lock_guard<std::mutex> lock(folderMutex);
+    // Copied out anyway, so large files are read rather than mapped; createFileInFolder
+    // rewrites files in place. Line endings come back the way a text-mode ifstream gave them.
+    ContentCache::View view = readFileView(folderName, filename, false);
+    return view.text();
+}
+
+ContentCache::View FolderSystem::readFileView(const std::string& folderName, const std::string& filename, bool mapLarge) {
+    auto folderLock = getFolderLock(folderName);
+    std::shared_lock<std::shared_mutex> lock(*folderLock);
     try {
         std::string folderPath = getFolderPath(folderName);
         if (!fs::exists(folderPath)) {
             log("Folder does not exist for reading: " + folderName);
-            return "";
+            return {};
         }
 
         std::string fullPath = folderPath + "/" + filename;
-        std::ifstream file(fullPath);
-        if (!file.is_open()) {
+        ContentCache::View view = contentCache.read(fullPath, mapLarge);
+        if (!view) {
             log("Failed to read file " + filename + " from folder " + folderName);
-            return "";
+            return {};
         }
 
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        log("Read file " + filename + " from folder " + folderName);
-        return buffer.str();
+        RLOG_TO(fileSystem.get(), FolderSystem, Debug, "Read file {} from folder {}", filename, folderName);
+        return view;
     }
     catch (const std::exception& e) {
         log("Error reading file from folder " + folderName + ": " + e.what());
-        return "";
+        return {};
     }
 }
 
+std::future<bool> FolderSystem::createFileInFolderAsync(const std::string& folderName, const std::string& filename, std::string content) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    auto future = promise->get_future();
+
+    std::string folderPath = getFolderPath(folderName);
+    {
+        // Only the existence check is serialized with create/delete; the write itself is atomic.
+        auto folderLock = getFolderLock(folderName);
+        std::shared_lock<std::shared_mutex> lock(*folderLock);
+        if (!fs::exists(folderPath)) {
+            log("Folder does not exist for file creation: " + folderName);
+            promise->set_value(false);
+            return future;
+        }
+    }
+
+    std::string fullPath = folderPath + "/" + filename;
+    asyncIO.writeFile(fullPath, std::move(content), false,
+        [this, promise, fullPath, folderName, filename](AsyncIO::Result result) {
+            contentCache.invalidate(fullPath);
+            folderIndex->update(fullPath);
+            if (result.ok()) {
+                RLOG_TO(fileSystem.get(), FolderSystem, Info, "Created file {} in folder {}", filename, folderName);
+            } else {
+                log("Failed to create file " + filename + " in folder " + folderName + ": " + result.error());
+            }
+            promise->set_value(result.ok());
+        }, getStagingPath());
+    return future;
+}
+
+std::future<std::string> FolderSystem::readFileInFolderAsync(const std::string& folderName, const std::string& filename) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+
+    std::string folderPath = getFolderPath(folderName);
+    {
+        auto folderLock = getFolderLock(folderName);
+        std::shared_lock<std::shared_mutex> lock(*folderLock);
+        if (!fs::exists(folderPath)) {
+            log("Folder does not exist for reading: " + folderName);
+            promise->set_value("");
+            return future;
+        }
+    }
+
+    asyncIO.readFile(folderPath + "/" + filename,
+        [this, promise, folderName, filename](std::optional<std::string> data) {
+            if (data) {
+                RLOG_TO(fileSystem.get(), FolderSystem, Debug, "Read file {} from folder {}", filename, folderName);
+                promise->set_value(std::move(*data));
+            } else {
+                log("Failed to read file " + filename + " from folder " + folderName);
+                promise->set_value("");
+            }
+        });
+    return future;
+}
+
 bool FolderSystem::backupFolder(const std::string& folderName) {
-    std::lock_guard<std::mutex> lock(folderMutex);
+    // Shared: reads of this folder carry on, writers wait so the copy is consistent.
+    auto folderLock = getFolderLock(folderName);
+    std::shared_lock<std::shared_mutex> lock(*folderLock);
     try {
         std::string folderPath = getFolderPath(folderName);
         if (!fs::exists(folderPath)) {
@@ -155,17 +242,26 @@ bool FolderSystem::backupFolder(const std::string& folderName) {
             return false;
         }
 
-        auto timestamp = std::chrono::system_clock::now();
-        auto timestampStr = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(
-            timestamp.time_since_epoch()).count());
-        std::string backupPath = baseAppDataPath + "/backup/" + folderName + "_" + timestampStr;
-        fs::create_directories(backupPath);
-
-        for (const auto& entry : fs::directory_iterator(folderPath)) {
-            fs::copy(entry.path(), backupPath + "/" + entry.path().filename().string());
+        // Incremental: unchanged files are hardlinked from the previous snapshot.
+        SnapshotBackup snapshots(baseAppDataPath + "/backup", folderName);
+        auto result = snapshots.create(folderPath);
+        if (!result.ok) {
+            log("Error backing up folder " + folderName + ": " + result.error);
+            return false;
         }
 
-        log("Backed up folder " + folderName + " to " + backupPath);
+        if (result.unchanged) {
+            log("Folder " + folderName + " unchanged since " + result.snapshotPath.string());
+        } else {
+            // Pruned snapshots vanish from the backup directory, otherwise only the new one is walked.
+            folderIndex->updateTree(result.pruned > 0 ? result.snapshotPath.parent_path() : result.snapshotPath);
+            log("Backed up folder " + folderName + " to " + result.snapshotPath.string() +
+                " (" + std::to_string(result.filesCopied) + " copied, " +
+                std::to_string(result.filesLinked) + " linked, " +
+                std::to_string(result.bytesCopied / 1024) + " KiB at " +
+                std::to_string(static_cast<std::uintmax_t>(result.bytesPerSecond / (1024 * 1024))) + " MiB/s, " +
+                std::to_string(result.pruned) + " old snapshots pruned)");
+        }
         return true;
     }
     catch (const fs::filesystem_error& e) {
@@ -174,26 +270,72 @@ bool FolderSystem::backupFolder(const std::string& folderName) {
     }
 }
 
+std::vector<FolderIndex::Entry> FolderSystem::findFiles(const FolderIndex::Query& query) const {
+    return folderIndex->find(query);
+}
+
+bool FolderSystem::refreshIndex() {
+    return folderIndex->refresh();
+}
+
 void FolderSystem::startMonitoring() {
     fileSystem->startMonitoring();
+    if (folderWatch == 0) {
+        folderWatch = fileSystem->getFileWatcher().subscribe(baseAppDataPath, true,
+            [this](const std::vector<FileWatcher::Event>& events) { onFilesChanged(events); },
+            [](const fs::path& relative) { return relative.empty() || *relative.begin() != kStagingDir; });
+    }
     log("Started monitoring for all folders");
 }
 
 void FolderSystem::stopMonitoring() {
+    if (folderWatch != 0) {
+        fileSystem->getFileWatcher().unsubscribe(folderWatch);
+        folderWatch = 0;
+    }
     fileSystem->stopMonitoring();
     log("Stopped monitoring for all folders");
 }
 
+void FolderSystem::onFilesChanged(const std::vector<FileWatcher::Event>& events) {
+    for (const auto& event : events) {
+        if (event.changes & FileWatcher::Overflow) {
+            // Events were lost, fall back to a full pass
+            contentCache.clear();
+            folderIndex->refresh();
+            continue;
+        }
+        if (event.changes & FileWatcher::Removed) {
+            // Windows can't tell whether a removed path was a directory, so treat it as one
+            contentCache.invalidateTree(event.path);
+            folderIndex->removeTree(event.path);
+            folderIndex->update(event.path);
+        } else if (event.isDirectory) {
+            folderIndex->updateTree(event.path);
+        } else {
+            contentCache.invalidate(event.path);
+            folderIndex->update(event.path);
+        }
+    }
+}
+
 std::string FolderSystem::getFolderPath(const std::string& folderName) {
     return baseAppDataPath + "/" + folderName;
 }
 
+std::shared_ptr<std::shared_mutex> FolderSystem::getFolderLock(const std::string& folderName) {
+    {
+        std::shared_lock<std::shared_mutex> lock(registryMutex);
+        auto it = folderLocks.find(folderName);
+        if (it != folderLocks.end()) return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(registryMutex);
+    auto& folderLock = folderLocks[folderName];
+    if (!folderLock) folderLock = std::make_shared<std::shared_mutex>();
+    return folderLock;
+}
+
 void FolderSystem::log(const std::string& message) {
-    auto now = std::chrono::system_clock::now();
-    auto now_c = std::chrono::system_clock::to_time_t(now);
-    std::tm localTime;
-    localtime_s(&localTime, &now_c);
-    std::stringstream ss;
-    ss << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S") << " [FolderSystem] - " << message;
-    fileSystem->log(ss.str());
+    RLOG_TO(fileSystem.get(), FolderSystem, Info, "{}", message);
 }
\ No newline at end of file
@@ -1,10 +1,16 @@
 #pragma once
 
 #include "../File/File_System.hpp"
+#include "../File/Content_Cache.hpp"
+#include "../File/Async_IO.hpp"
+#include "Folder_Index.hpp"
 #include <string>
 #include <filesystem>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace fs = std::filesystem;
@@ -29,10 +35,28 @@ public:
     // Read a file from a specific folder
     std::string readFileInFolder(const std::string& folderName, const std::string& filename);
 
+    // Read a file without copying it: small files come from the content cache, large ones are mapped
+    // unless mapLarge is false. Only map files no one truncates in place while the view is alive
+    ContentCache::View readFileView(const std::string& folderName, const std::string& filename, bool mapLarge = true);
+
+    // Asynchronous create: written to a temp file in the staging directory and renamed into place,
+    // so readers and backups see the old or the new file and no folder lock is held while the
+    // I/O is in flight
+    std::future<bool> createFileInFolderAsync(const std::string& folderName, const std::string& filename, std::string content);
+
+    // Asynchronous read, empty on failure like readFileInFolder
+    std::future<std::string> readFileInFolderAsync(const std::string& folderName, const std::string& filename);
+
     // Backup all files in a specific folder
     bool backupFolder(const std::string& folderName);
 
-    // Start monitoring all folders
+    // Search the app data tree (folders and backups) without touching the disk
+    std::vector<FolderIndex::Entry> findFiles(const FolderIndex::Query& query) const;
+
+    // Bring the index up to date with changes made outside this class
+    bool refreshIndex();
+
+    // Start monitoring all folders: changes made on disk by anyone update the index and the content cache
     void startMonitoring();
 
     // Stop monitoring all folders
@@ -42,13 +66,39 @@ private:
     std::string appName;
     std::string baseAppDataPath;
     std::unique_ptr<FileSystem> fileSystem;
-    std::mutex folderMutex;
     std::vector<std::string> managedFolders;
 
+    // Reader/writer lock per folder: reads and backups share it, writes and deletes own it.
+    // registryMutex only guards the lock table and managedFolders, never any I/O.
+    std::shared_mutex registryMutex;
+    std::unordered_map<std::string, std::shared_ptr<std::shared_mutex>> folderLocks;
+
+    // Contents of recently read files, invalidated by our own writes and by size/mtime changes
+    ContentCache contentCache;
+
+    // Recursive index of baseAppDataPath, built in initialize() and updated by our own writes
+    // and, while monitoring, by the file watcher
+    std::unique_ptr<FolderIndex> folderIndex;
+    FileWatcher::SubscriptionId folderWatch = 0;
+
+    // io_uring (or thread pool) for the async calls; declared last so it drains before the rest goes
+    AsyncIO asyncIO;
+
     // Get full path for a folder
     std::string getFolderPath(const std::string& folderName);
 
-    // Log folder operations
+    // Temp files of async writes, outside every folder so backups never pick up a partial one
+    static constexpr const char* kStagingDir = ".staging";
+    std::string getStagingPath() const { return baseAppDataPath + "/" + kStagingDir; }
+
+    // Watcher callback for baseAppDataPath
+    void onFilesChanged(const std::vector<FileWatcher::Event>& events);
+
+    // Get (or create) the lock for a folder
+    std::shared_ptr<std::shared_mutex> getFolderLock(const std::string& folderName);
+
+    // Log folder operations at INFO; FileSystem adds the timestamp. Per-file messages use
+    // RLOG_TO so they can be filtered by the FolderSystem module level without formatting.
     void log(const std::string& message);
 
     // Grant LoggerSystem access to private members
@@ -1,4 +1,5 @@
 #include "Fiber_Pool.hpp"
+#include "File/Log_Modules.hpp"
 #include <Windows.h>
 #include <cassert>
 
@@ -25,6 +26,7 @@ namespace Grim_Reaperz_Menu
         }
 
         // Create the specified number of fibers
+        int created = 0;
         for (int i = 0; i < num_fibers; ++i)
         {
             void* fiber = CreateFiber(0, FiberEntry, this);
@@ -33,8 +35,10 @@ namespace Grim_Reaperz_Menu
                 m_Jobs.push([fiber]() {
                     SwitchToFiber(fiber);
                 });
+                ++created;
             }
         }
+        RLOG_DEBUG(FiberPool, "Created {} of {} fibers", created, num_fibers);
     }
 
     void FiberPool::DestroyImpl()
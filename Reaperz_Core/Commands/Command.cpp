@@ -1,6 +1,7 @@
 #include "Reaperz_core/Utilities/Joaat.hpp"
 #include "Command.hpp"
 #include "Commands.hpp"
+#include "File/Log_Modules.hpp"
 
 namespace Grim_Reaperz_Menu
 {
@@ -16,6 +17,7 @@ namespace Grim_Reaperz_Menu
 
 	void Command::Call()
 	{
+		RLOG_TRACE(Commands, "Call {}", m_Name);
 		OnCall();
 	}
 
@@ -0,0 +1,189 @@
+#include "Player.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace Grim_Reaperz_Menu
+{
+	void PlayerRoster::View::GetAll(PlayerOrder& out) const
+	{
+		out.Count = 0;
+		for (std::uint8_t slot = 0; slot < MaxPlayers; ++slot)
+		{
+			if (m_Columns.Active.test(slot))
+				out.Slots[out.Count++] = slot;
+		}
+	}
+
+	void PlayerRoster::View::SortBy(PlayerField field, PlayerOrder& out, bool descending) const
+	{
+		GetAll(out);
+
+		auto sort = [&](auto&& key) {
+			std::sort(out.Slots.begin(), out.Slots.begin() + out.Count, [&](std::uint8_t a, std::uint8_t b) {
+				auto ka = key(a);
+				auto kb = key(b);
+				// NaN compares false both ways, which std::sort can't cope with, so give it an explicit place
+				if constexpr (std::is_floating_point_v<decltype(ka)>)
+				{
+					bool na = std::isnan(ka);
+					bool nb = std::isnan(kb);
+					if (na || nb)
+						return na == nb ? a < b : nb;
+				}
+				if (ka == kb)
+					return a < b;
+				return descending ? kb < ka : ka < kb;
+			});
+		};
+
+		const auto& r = m_Columns;
+		switch (field)
+		{
+		case PlayerField::Name: sort([&](std::uint8_t s) { return std::string_view(r.Names[s].data()); }); break;
+		case PlayerField::RockstarId: sort([&](std::uint8_t s) { return r.RockstarIds[s]; }); break;
+		case PlayerField::Rank: sort([&](std::uint8_t s) { return r.Ranks[s]; }); break;
+		case PlayerField::Health: sort([&](std::uint8_t s) { return r.Health[s]; }); break;
+		case PlayerField::Armor: sort([&](std::uint8_t s) { return r.Armor[s]; }); break;
+		case PlayerField::Position: sort([&](std::uint8_t s) { return r.X[s] * r.X[s] + r.Y[s] * r.Y[s] + r.Z[s] * r.Z[s]; }); break;
+		case PlayerField::WantedLevel: sort([&](std::uint8_t s) { return r.WantedLevels[s]; }); break;
+		case PlayerField::Host: sort([&](std::uint8_t s) { return (r.Flags[s] & FlagHost) != 0; }); break;
+		case PlayerField::Friend: sort([&](std::uint8_t s) { return (r.Flags[s] & FlagFriend) != 0; }); break;
+		case PlayerField::Modder: sort([&](std::uint8_t s) { return (r.Flags[s] & FlagModder) != 0; }); break;
+		default: break; // slot order
+		}
+	}
+
+	void PlayerRoster::BeginTick()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Columns.Joined.reset();
+		m_Columns.Left.reset();
+		m_Columns.Changed.fill(0);
+		++m_Columns.Tick;
+	}
+
+	void PlayerRoster::Apply(std::span<const PlayerDiff> diffs)
+	{
+		std::unique_lock lock(m_Mutex);
+		for (const auto& diff : diffs)
+		{
+			if (diff.Slot >= MaxPlayers)
+				continue;
+
+			switch (diff.Kind)
+			{
+			case PlayerDiffKind::Joined: JoinImpl(diff.Slot, diff.Record); break;
+			case PlayerDiffKind::Left: LeaveImpl(diff.Slot); break;
+			case PlayerDiffKind::Changed: ChangeImpl(diff.Slot, diff.Fields, diff.Record); break;
+			}
+		}
+	}
+
+	std::uint32_t PlayerRoster::Sync(std::uint8_t slot, const PlayerRecord& record)
+	{
+		if (slot >= MaxPlayers)
+			return 0;
+
+		std::unique_lock lock(m_Mutex);
+		if (!m_Columns.Active.test(slot))
+		{
+			JoinImpl(slot, record);
+			return static_cast<std::uint32_t>(PlayerField::All);
+		}
+		return ChangeImpl(slot, static_cast<std::uint32_t>(PlayerField::All), record);
+	}
+
+	void PlayerRoster::Remove(std::uint8_t slot)
+	{
+		if (slot >= MaxPlayers)
+			return;
+
+		std::unique_lock lock(m_Mutex);
+		LeaveImpl(slot);
+	}
+
+	void PlayerRoster::JoinImpl(std::uint8_t slot, const PlayerRecord& record)
+	{
+		if (m_Columns.Active.test(slot))
+			LeaveImpl(slot); // missed a leave, treat it as a new player
+
+		m_Columns.Active.set(slot);
+		m_Columns.Joined.set(slot);
+		m_Columns.Left.reset(slot);
+		++m_Columns.Generation[slot];
+
+		m_Columns.Names[slot].fill('\0');
+		m_Columns.Flags[slot] = 0;
+		ChangeImpl(slot, static_cast<std::uint32_t>(PlayerField::All), record);
+		m_Columns.Changed[slot] = static_cast<std::uint32_t>(PlayerField::All);
+	}
+
+	void PlayerRoster::LeaveImpl(std::uint8_t slot)
+	{
+		if (!m_Columns.Active.test(slot))
+			return;
+
+		m_Columns.Active.reset(slot);
+		m_Columns.Joined.reset(slot);
+		m_Columns.Left.set(slot);
+		m_Columns.Changed[slot] = 0;
+	}
+
+	std::uint32_t PlayerRoster::ChangeImpl(std::uint8_t slot, std::uint32_t fields, const PlayerRecord& record)
+	{
+		if (!m_Columns.Active.test(slot))
+			return 0;
+
+		std::uint32_t changed = 0;
+		auto update = [&](PlayerField field, auto& column, auto value) {
+			if (HasField(fields, field) && column[slot] != value)
+			{
+				column[slot] = value;
+				changed |= static_cast<std::uint32_t>(field);
+			}
+		};
+
+		if (HasField(fields, PlayerField::Name))
+		{
+			auto& name = m_Columns.Names[slot];
+			auto len = std::min(record.Name.size(), name.size() - 1);
+			if (std::string_view(name.data()) != record.Name.substr(0, len))
+			{
+				std::memcpy(name.data(), record.Name.data(), len);
+				name[len] = '\0';
+				changed |= static_cast<std::uint32_t>(PlayerField::Name);
+			}
+		}
+
+		update(PlayerField::RockstarId, m_Columns.RockstarIds, record.RockstarId);
+		update(PlayerField::Rank, m_Columns.Ranks, record.Rank);
+		update(PlayerField::Health, m_Columns.Health, record.Health);
+		update(PlayerField::Armor, m_Columns.Armor, record.Armor);
+		update(PlayerField::WantedLevel, m_Columns.WantedLevels, record.WantedLevel);
+
+		if (HasField(fields, PlayerField::Position) && (m_Columns.X[slot] != record.X || m_Columns.Y[slot] != record.Y || m_Columns.Z[slot] != record.Z))
+		{
+			m_Columns.X[slot] = record.X;
+			m_Columns.Y[slot] = record.Y;
+			m_Columns.Z[slot] = record.Z;
+			changed |= static_cast<std::uint32_t>(PlayerField::Position);
+		}
+
+		auto flag = [&](PlayerField field, std::uint8_t bit, bool value) {
+			if (HasField(fields, field) && ((m_Columns.Flags[slot] & bit) != 0) != value)
+			{
+				m_Columns.Flags[slot] ^= bit;
+				changed |= static_cast<std::uint32_t>(field);
+			}
+		};
+
+		flag(PlayerField::Host, FlagHost, record.Host);
+		flag(PlayerField::Friend, FlagFriend, record.Friend);
+		flag(PlayerField::Modder, FlagModder, record.Modder);
+
+		m_Columns.Changed[slot] |= changed;
+		return changed;
+	}
+}
@@ -1 +1,298 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
 
+namespace Grim_Reaperz_Menu
+{
+	inline constexpr std::size_t MaxPlayers = 32;
+
+	// one bit per column so diffs and change masks can name any subset of fields
+	enum class PlayerField : std::uint32_t
+	{
+		None        = 0,
+		Name        = 1 << 0,
+		RockstarId  = 1 << 1,
+		Rank        = 1 << 2,
+		Health      = 1 << 3,
+		Armor       = 1 << 4,
+		Position    = 1 << 5,
+		WantedLevel = 1 << 6,
+		Host        = 1 << 7,
+		Friend      = 1 << 8,
+		Modder      = 1 << 9,
+		All         = (1 << 10) - 1
+	};
+
+	inline constexpr PlayerField operator|(PlayerField a, PlayerField b)
+	{
+		return static_cast<PlayerField>(static_cast<std::uint32_t>(a) | static_cast<std::uint32_t>(b));
+	}
+
+	inline constexpr bool HasField(std::uint32_t mask, PlayerField field)
+	{
+		return (mask & static_cast<std::uint32_t>(field)) != 0;
+	}
+
+	// row form of a single player, only used to feed the roster and never stored
+	struct PlayerRecord
+	{
+		std::string_view Name;
+		std::uint64_t RockstarId = 0;
+		int Rank = 0;
+		float Health = 0.0f;
+		float Armor = 0.0f;
+		float X = 0.0f, Y = 0.0f, Z = 0.0f;
+		std::uint8_t WantedLevel = 0;
+		bool Host = false;
+		bool Friend = false;
+		bool Modder = false;
+	};
+
+	enum class PlayerDiffKind : std::uint8_t
+	{
+		Joined,
+		Left,
+		Changed
+	};
+
+	// a single per-tick change; Fields says which members of Record are meaningful for Changed
+	struct PlayerDiff
+	{
+		PlayerDiffKind Kind;
+		std::uint8_t Slot;
+		std::uint32_t Fields = static_cast<std::uint32_t>(PlayerField::All);
+		PlayerRecord Record{};
+	};
+
+	// stable handle, the generation changes every time a slot is reused by a new player
+	struct PlayerId
+	{
+		std::uint8_t Slot = 0xFF;
+		std::uint16_t Generation = 0;
+
+		bool operator==(const PlayerId&) const = default;
+	};
+
+	// caller owned index buffer for sorted/filtered results, never allocates
+	struct PlayerOrder
+	{
+		std::array<std::uint8_t, MaxPlayers> Slots{};
+		std::size_t Count = 0;
+
+		const std::uint8_t* begin() const
+		{
+			return Slots.data();
+		}
+
+		const std::uint8_t* end() const
+		{
+			return Slots.data() + Count;
+		}
+	};
+
+	class PlayerRoster
+	{
+	public:
+		using NameBuffer = std::array<char, 32>;
+
+		// every column of the roster, grouped so a view can copy all of them in one go (a few KB)
+		struct Columns
+		{
+			std::uint64_t Tick = 0;
+
+			std::bitset<MaxPlayers> Active;
+			std::bitset<MaxPlayers> Joined;
+			std::bitset<MaxPlayers> Left;
+			std::array<std::uint16_t, MaxPlayers> Generation{};
+			std::array<std::uint32_t, MaxPlayers> Changed{};
+
+			std::array<NameBuffer, MaxPlayers> Names{};
+			std::array<std::uint64_t, MaxPlayers> RockstarIds{};
+			std::array<int, MaxPlayers> Ranks{};
+			std::array<float, MaxPlayers> Health{};
+			std::array<float, MaxPlayers> Armor{};
+			std::array<float, MaxPlayers> X{};
+			std::array<float, MaxPlayers> Y{};
+			std::array<float, MaxPlayers> Z{};
+			std::array<std::uint8_t, MaxPlayers> WantedLevels{};
+			std::array<std::uint8_t, MaxPlayers> Flags{};
+		};
+
+		// read-only copy of the columns taken under a shared lock, the tick thread is never blocked by a view that is still alive
+		class View
+		{
+		public:
+			explicit View(const PlayerRoster& roster)
+			{
+				std::shared_lock lock(roster.m_Mutex);
+				m_Columns = roster.m_Columns;
+			}
+
+			bool IsActive(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers && m_Columns.Active.test(slot);
+			}
+
+			std::size_t Count() const
+			{
+				return m_Columns.Active.count();
+			}
+
+			PlayerId GetId(std::uint8_t slot) const
+			{
+				if (slot >= MaxPlayers)
+					return {};
+				return {slot, m_Columns.Generation[slot]};
+			}
+
+			// true if the handle still refers to the same player that was in the slot when it was taken
+			bool IsValid(PlayerId id) const
+			{
+				return IsActive(id.Slot) && m_Columns.Generation[id.Slot] == id.Generation;
+			}
+
+			std::string_view GetName(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? std::string_view(m_Columns.Names[slot].data()) : std::string_view();
+			}
+
+			std::uint64_t GetRockstarId(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.RockstarIds[slot] : 0;
+			}
+
+			int GetRank(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.Ranks[slot] : 0;
+			}
+
+			float GetHealth(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.Health[slot] : 0.0f;
+			}
+
+			float GetArmor(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.Armor[slot] : 0.0f;
+			}
+
+			float GetX(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.X[slot] : 0.0f;
+			}
+
+			float GetY(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.Y[slot] : 0.0f;
+			}
+
+			float GetZ(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.Z[slot] : 0.0f;
+			}
+
+			std::uint8_t GetWantedLevel(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.WantedLevels[slot] : 0;
+			}
+
+			bool IsHost(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers && (m_Columns.Flags[slot] & FlagHost);
+			}
+
+			bool IsFriend(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers && (m_Columns.Flags[slot] & FlagFriend);
+			}
+
+			bool IsModder(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers && (m_Columns.Flags[slot] & FlagModder);
+			}
+
+			// fields that changed during the last tick, for UIs that only want to redraw what moved
+			std::uint32_t GetChanged(std::uint8_t slot) const
+			{
+				return slot < MaxPlayers ? m_Columns.Changed[slot] : 0;
+			}
+
+			const std::bitset<MaxPlayers>& GetJoined() const
+			{
+				return m_Columns.Joined;
+			}
+
+			const std::bitset<MaxPlayers>& GetLeft() const
+			{
+				return m_Columns.Left;
+			}
+
+			std::uint64_t GetTick() const
+			{
+				return m_Columns.Tick;
+			}
+
+			// active slots in ascending slot order
+			void GetAll(PlayerOrder& out) const;
+
+			// active slots ordered by a column, ties are broken by slot so the order is stable between ticks
+			// NaN values sort after every number in either direction
+			void SortBy(PlayerField field, PlayerOrder& out, bool descending = false) const;
+
+			// narrows an existing order in place, keeps relative order
+			template<typename Pred>
+			void Filter(PlayerOrder& order, Pred&& pred) const
+			{
+				std::size_t n = 0;
+				for (std::size_t i = 0; i < order.Count; ++i)
+				{
+					if (pred(*this, order.Slots[i]))
+						order.Slots[n++] = order.Slots[i];
+				}
+				order.Count = n;
+			}
+
+		private:
+			Columns m_Columns;
+		};
+
+		PlayerRoster() = default;
+		PlayerRoster(const PlayerRoster&) = delete;
+		PlayerRoster& operator=(const PlayerRoster&) = delete;
+
+		View Read() const
+		{
+			return View(*this);
+		}
+
+		// clears last tick's change masks, call once per tick before applying diffs
+		void BeginTick();
+
+		// applies a batch of diffs under one exclusive lock
+		void Apply(std::span<const PlayerDiff> diffs);
+
+		// compares the record against the stored row and writes only the fields that differ, returns the changed mask
+		std::uint32_t Sync(std::uint8_t slot, const PlayerRecord& record);
+		void Remove(std::uint8_t slot);
+
+	private:
+		enum : std::uint8_t
+		{
+			FlagHost   = 1 << 0,
+			FlagFriend = 1 << 1,
+			FlagModder = 1 << 2
+		};
+
+		void JoinImpl(std::uint8_t slot, const PlayerRecord& record);
+		void LeaveImpl(std::uint8_t slot);
+		std::uint32_t ChangeImpl(std::uint8_t slot, std::uint32_t fields, const PlayerRecord& record);
+
+		mutable std::shared_mutex m_Mutex;
+		Columns m_Columns;
+	};
+}
@@ -0,0 +1,39 @@
+// Config_Converter.cpp
+// Rewrites a config (JSON, binary or delta) as a full JSON or binary config.
+//
+//   Config_Converter config.json config.rcfg
+//   Config_Converter layout.delta.json layout.json json
+//
+// Without a format argument the output extension decides: .rcfg is binary, anything else JSON.
+#include "../Configuration/Configuration_Binary_Format.hpp"
+#include "../Configuration/Configuration_System.hpp"
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <input> <output> [json|binary]\n";
+        return 2;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    ConfigSystem::ConfigFormat format = fs::path(output).extension() == ConfigBinaryFormat::kExtension
+        ? ConfigSystem::ConfigFormat::Binary
+        : ConfigSystem::ConfigFormat::Json;
+    if (argc == 4) {
+        std::string name = argv[3];
+        if (name == "json") {
+            format = ConfigSystem::ConfigFormat::Json;
+        } else if (name == "binary") {
+            format = ConfigSystem::ConfigFormat::Binary;
+        } else {
+            std::cerr << "Unknown format " << name << ", expected json or binary\n";
+            return 2;
+        }
+    }
+
+    // ConvertConfig logs the reason to stderr.
+    if (!ConfigSystem::ConvertConfig(input, output, format)) return 1;
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Config_Format_Benchmark.cpp
+// Compares the JSON and binary (.rcfg) config formats on one generated set of components:
+// SaveConfig and LoadConfig times and the size of the file each writes.
+//
+//   Config_Format_Benchmark [components] [runs]
+//
+// Defaults to 10000 components and 5 runs; prints the fastest and median run of each.
+// The configs are written to the working directory and removed again.
+#include "../Configuration/Configuration_Binary_Format.hpp"
+#include "../Configuration/Configuration_System.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Timing {
+    double best = 0;
+    double median = 0;
+    bool ok = true;
+};
+
+template<typename Run>
+Timing Measure(int runs, Run run) {
+    std::vector<double> times;
+    Timing timing;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        timing.ok &= run();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    timing.best = times.front();
+    timing.median = times[times.size() / 2];
+    return timing;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 10000;
+    int runs = argc > 2 ? (std::max)(1, std::stoi(argv[2])) : 5;
+
+    ConfigSystem config;
+    for (int i = 0; i < count; ++i) {
+        ConfigSystem::ComponentId id = config.AddComponent("Window" + std::to_string(i));
+        ConfigSystem::ComponentState state = config.GetComponent(id);
+        state.position = ImVec2(static_cast<float>(i % 1920), static_cast<float>(i % 1080));
+        state.size = ImVec2(320.0f, 240.0f);
+        state.slider_float = i * 0.25f;
+        state.slider_int = i;
+        state.checkbox = i % 2 == 0;
+        config.SetComponent(id, state);
+    }
+
+    struct Format {
+        const char* name;
+        ConfigSystem::ConfigFormat format;
+        std::string filename;
+    };
+    const Format formats[] = {
+        {"json", ConfigSystem::ConfigFormat::Json, "config_format_benchmark.json"},
+        {"binary", ConfigSystem::ConfigFormat::Binary, std::string("config_format_benchmark") + ConfigBinaryFormat::kExtension},
+    };
+
+    std::printf("%d components, %d runs\n", count, runs);
+    std::printf("%-8s %12s %14s %14s %14s %14s\n", "format", "bytes", "save best ms", "save median", "load best ms", "load median");
+    bool ok = true;
+    for (const Format& format : formats) {
+        Timing save = Measure(runs, [&]() { return config.SaveConfig(format.filename, format.format); });
+        Timing load = Measure(runs, [&]() {
+            ConfigSystem loaded;
+            return loaded.LoadConfig(format.filename);
+        });
+        std::error_code ec;
+        std::uintmax_t size = fs::file_size(format.filename, ec);
+        std::printf("%-8s %12ju %14.2f %14.2f %14.2f %14.2f\n", format.name, ec ? std::uintmax_t{0} : size,
+                    save.best, save.median, load.best, load.median);
+        if (!save.ok || !load.ok) {
+            std::cerr << format.name << ": save or load failed\n";
+            ok = false;
+        }
+        fs::remove(format.filename, ec);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+// Config_Load_Benchmark.cpp
+// Times loading one generated JSON config with the streaming SAX loader and with the json DOM
+// path LoadConfig used before it (ifstream >> json, then one DeserializeComponent per entry).
+//
+//   Config_Load_Benchmark [components] [runs]
+//
+// Defaults to 10000 components and 5 runs; prints the fastest and median run of each.
+// The config is written to the working directory and removed again.
+#include "../Configuration/Configuration_Stream_Loader.hpp"
+#include "../Configuration/Configuration_System.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using ComponentState = ConfigSystem::ComponentState;
+using ComponentMap = std::unordered_map<std::string, ComponentState>;
+
+// ConfigSystem::DeserializeComponent as it was, it's private.
+ComponentState DomComponent(const json& j) {
+    ComponentState s;
+    s.id = j.value("id", "");
+    s.is_open = j.value("is_open", true);
+    auto pos = j.value("position", std::vector<float>{0, 0});
+    if (pos.size() == 2) s.position = ImVec2(pos[0], pos[1]);
+    auto size = j.value("size", std::vector<float>{0, 0});
+    if (size.size() == 2) s.size = ImVec2(size[0], size[1]);
+    s.slider_float = j.value("slider_float", 0.0f);
+    s.slider_int = j.value("slider_int", 0);
+    s.checkbox = j.value("checkbox", false);
+    auto col = j.value("color", std::vector<float>{1, 1, 1, 1});
+    if (col.size() == 4) s.color = ImVec4(col[0], col[1], col[2], col[3]);
+    return s;
+}
+
+bool LoadDom(const std::string& filename, ComponentMap& out) {
+    std::ifstream file(filename);
+    json j;
+    file >> j;
+    for (auto& [id, data] : j["components"].items()) out[id] = DomComponent(data);
+    return true;
+}
+
+bool LoadStream(const std::string& filename, ComponentMap& out) {
+    return ConfigStreamLoader::LoadFile(filename, [&out](ComponentState&& state) {
+        std::string id = state.id;
+        out[std::move(id)] = std::move(state);
+    });
+}
+
+struct Timing {
+    double best = 0;
+    double median = 0;
+    size_t components = 0;
+};
+
+template<typename Load>
+Timing Measure(int runs, Load load) {
+    std::vector<double> times;
+    Timing timing;
+    for (int run = 0; run < runs; ++run) {
+        ComponentMap components;
+        auto start = std::chrono::steady_clock::now();
+        load(components);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        timing.components = components.size();
+    }
+    std::sort(times.begin(), times.end());
+    timing.best = times.front();
+    timing.median = times[times.size() / 2];
+    return timing;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 10000;
+    int runs = argc > 2 ? (std::max)(1, std::stoi(argv[2])) : 5;
+    const std::string filename = "config_load_benchmark.json";
+
+    {
+        ConfigSystem config;
+        for (int i = 0; i < count; ++i) {
+            ConfigSystem::ComponentId id = config.AddComponent("Window" + std::to_string(i));
+            ComponentState state = config.GetComponent(id);
+            state.position = ImVec2(static_cast<float>(i % 1920), static_cast<float>(i % 1080));
+            state.size = ImVec2(320.0f, 240.0f);
+            state.slider_float = i * 0.25f;
+            state.slider_int = i;
+            state.checkbox = i % 2 == 0;
+            config.SetComponent(id, state);
+        }
+        if (!config.SaveConfig(filename)) {
+            std::cerr << "Cannot write " << filename << "\n";
+            return 1;
+        }
+    }
+
+    Timing dom = Measure(runs, [&](ComponentMap& out) { LoadDom(filename, out); });
+    Timing stream = Measure(runs, [&](ComponentMap& out) { LoadStream(filename, out); });
+    Timing system = Measure(runs, [&](ComponentMap&) {
+        ConfigSystem config;
+        config.LoadConfig(filename);
+    });
+
+    std::printf("%d components, %ju bytes, %d runs\n", count, static_cast<std::uintmax_t>(fs::file_size(filename)), runs);
+    std::printf("%-26s %10s %10s\n", "", "best ms", "median ms");
+    std::printf("%-26s %10.2f %10.2f\n", "DOM (json >> + items)", dom.best, dom.median);
+    std::printf("%-26s %10.2f %10.2f\n", "SAX stream loader", stream.best, stream.median);
+    std::printf("%-26s %10.2f %10.2f\n", "ConfigSystem::LoadConfig", system.best, system.median);
+    if (dom.components != stream.components) {
+        std::cerr << "Loaders disagree: " << dom.components << " vs " << stream.components << " components\n";
+    }
+
+    std::error_code ec;
+    fs::remove(filename, ec);
+    return dom.components == stream.components ? 0 : 1;
+}
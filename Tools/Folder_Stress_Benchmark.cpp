@@ -0,0 +1,102 @@
+// Folder_Stress_Benchmark.cpp
+// Read throughput of FolderSystem as reader threads are added, with one thread backing up a
+// folder in a loop. With per-folder reader/writer locks the rate should grow with the cores
+// until the disk or page cache is the limit, and the backups shouldn't stall readers of other
+// folders.
+//
+//   Folder_Stress_Benchmark [max threads] [seconds per step]
+//
+// Thread counts double from 1 up to max threads (default: hardware concurrency). The folders
+// it creates under the app data directory are deleted again at the end.
+#include "../Folder/Folder_System.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kFolders = 16;
+constexpr int kFilesPerFolder = 32;
+constexpr size_t kFileSize = 4 * 1024;
+
+std::string folderName(int folder) {
+    return "stress_" + std::to_string(folder);
+}
+
+std::string fileName(int file) {
+    return "file_" + std::to_string(file) + ".txt";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned maxThreads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1])) : std::thread::hardware_concurrency();
+    double seconds = argc > 2 ? std::stod(argv[2]) : 2.0;
+    maxThreads = (std::max)(1u, maxThreads);
+
+    FolderSystem folders("FolderStressBenchmark");
+    if (!folders.initialize()) {
+        std::fprintf(stderr, "Failed to initialize the folder system\n");
+        return 1;
+    }
+    std::string content(kFileSize, 'x');
+    for (int folder = 0; folder < kFolders; ++folder) {
+        folders.createFolder(folderName(folder));
+        for (int file = 0; file < kFilesPerFolder; ++file) {
+            folders.createFileInFolder(folderName(folder), fileName(file), content);
+        }
+    }
+
+    std::printf("%8s %14s %10s %10s\n", "threads", "reads/s", "scaling", "backups");
+    double baseline = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        std::atomic<bool> stop{false};
+        std::atomic<std::uint64_t> reads{0}, failures{0}, backups{0};
+
+        // Backs up folder 0 over and over; readers of the other folders must not wait on it.
+        std::thread backup([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (folders.backupFolder(folderName(0))) backups.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        std::vector<std::thread> readers;
+        for (unsigned t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t]() {
+                std::minstd_rand random(t + 1);
+                std::uint64_t done = 0, failed = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    int folder = static_cast<int>(random() % kFolders);
+                    int file = static_cast<int>(random() % kFilesPerFolder);
+                    if (folders.readFileInFolder(folderName(folder), fileName(file)).size() == kFileSize) ++done;
+                    else ++failed;
+                }
+                reads.fetch_add(done, std::memory_order_relaxed);
+                failures.fetch_add(failed, std::memory_order_relaxed);
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (auto& reader : readers) reader.join();
+        backup.join();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double rate = static_cast<double>(reads.load()) / elapsed;
+        if (threads == 1) baseline = rate;
+        std::printf("%8u %14.0f %9.2fx %10llu\n", threads, rate, baseline > 0 ? rate / baseline : 0.0,
+                    static_cast<unsigned long long>(backups.load()));
+        if (failures.load() > 0) {
+            std::fprintf(stderr, "%llu reads failed\n", static_cast<unsigned long long>(failures.load()));
+        }
+    }
+
+    for (int folder = 0; folder < kFolders; ++folder) folders.deleteFolder(folderName(folder));
+    return 0;
+}
@@ -0,0 +1,44 @@
+// Log_Decoder.cpp
+// Turns binary logs (.rlog) back into the JSON lines a text log would hold.
+//
+//   Log_Decoder log_20250101.rlog [more.rlog ...] > log.txt
+#include "../File/Log_Format.hpp"
+#include "../File/Mapped_File.hpp"
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <log.rlog> [more.rlog ...]\n";
+        return 2;
+    }
+
+    int status = 0;
+    std::string out;
+    for (int i = 1; i < argc; ++i) {
+        MappedFile file(argv[i]);
+        if (!file.isOpen()) {
+            std::cerr << argv[i] << ": cannot open\n";
+            status = 1;
+            continue;
+        }
+
+        std::string error;
+        bool ok = LogBinaryFormat::decode(file.view(), [&out](const std::string& line) {
+            out += line;
+            out += '\n';
+            if (out.size() >= 64 * 1024) {
+                std::fwrite(out.data(), 1, out.size(), stdout);
+                out.clear();
+            }
+        }, &error);
+        // Whatever decoded before a torn tail is still printed.
+        if (!ok) {
+            std::cerr << argv[i] << ": " << error << "\n";
+            status = 1;
+        }
+    }
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    return status;
+}